@@ -28,10 +28,19 @@
 
 NS_ASSUME_NONNULL_BEGIN
 
+@class _SPLRemoteObjectMethod;
+
+/**
+ @abstract  A remote object message is an array of the method identifier followed by all arguments except the completion handler. nil arguments are represented by _SPLNil.
+ */
 @interface NSInvocation (SPLRemoteObject)
 
-+ (nullable NSInvocation *)invocationWithRemoteObjectDictionaryRepresentation:(NSDictionary *)dictionaryRepresentation forProtocol:(Protocol *)protocol;
-- (NSDictionary *)remoteObjectDictionaryRepresentationForProtocol:(Protocol *)protocol;
+/**
+ @param methods Local methods indexed by the method identifiers of the sender, see `-[_SPLRemoteObjectMethodTable methodsMatchingHandshakeRepresentation:]`.
+ @return nil if the method is unknown, incompatible or the number of arguments does not match.
+ */
++ (nullable NSInvocation *)invocationWithRemoteObjectMessage:(NSArray *)message methods:(NSArray *)methods;
+- (NSArray *)remoteObjectMessageForMethod:(_SPLRemoteObjectMethod *)method;
 
 @end
 
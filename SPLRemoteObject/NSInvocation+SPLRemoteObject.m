@@ -25,126 +25,108 @@
 //
 
 #import "NSInvocation+SPLRemoteObject.h"
+#import "_SPLRemoteObjectMethodTable.h"
 #import "_SPLNil.h"
+#import "_SPLRemoteObjectBinaryCodec.h"
 #import <objc/runtime.h>
-#import <CommonCrypto/CommonDigest.h>
-
-static NSString *protocol_getHashForSelector(Protocol *protocol, SEL selector)
-{
-    NSCParameterAssert(protocol);
-    NSCParameterAssert(selector);
-
-    struct objc_method_description methodDescription = protocol_getMethodDescription(protocol, selector, YES, YES);
-    if (!methodDescription.name || !methodDescription.types) {
-        methodDescription = protocol_getMethodDescription(protocol, selector, NO, YES);
-    }
-
-    if (!methodDescription.name) {
-        return nil;
-    }
-
-    NSMethodSignature *signature = [NSMethodSignature signatureWithObjCTypes:methodDescription.types];
-
-    NSMutableString *stringToHash = [NSMutableString stringWithString:NSStringFromSelector(methodDescription.name)];
-    [stringToHash appendFormat:@"%c", signature.methodReturnType[0]];
-
-    for (NSInteger i = 0; i < signature.numberOfArguments; i++) {
-        [stringToHash appendFormat:@"%c", [signature getArgumentTypeAtIndex:i][0]];
-    }
-
-    const char *string = stringToHash.UTF8String;
-    unsigned char md5Buffer[CC_MD5_DIGEST_LENGTH];
-    CC_MD5(string, (CC_LONG)strlen(string), md5Buffer);
-
-    // Convert MD5 value in the buffer to NSString of hex values
-    NSMutableString *hash = [NSMutableString stringWithCapacity:CC_MD5_DIGEST_LENGTH * 2];
-    for(int i = 0; i < CC_MD5_DIGEST_LENGTH; i++) {
-        [hash appendFormat:@"%02x", md5Buffer[i]];
-    }
-    
-    return hash;
-}
 
 
 
 @implementation NSInvocation (SPLRemoteObject)
 
-+ (NSInvocation *)invocationWithRemoteObjectDictionaryRepresentation:(NSDictionary *)dictionaryRepresentation forProtocol:(Protocol *)protocol
++ (NSInvocation *)invocationWithRemoteObjectMessage:(NSArray *)message methods:(NSArray *)methods
 {
-    NSParameterAssert(protocol);
-
-    NSString *selectorName = dictionaryRepresentation[@"selector"];
-    SEL selector = NSSelectorFromString(selectorName);
-
-
+    NSParameterAssert(methods);
 
-    if (!selector) {
-        NSLog(@"selector %@ not found", selectorName);
+    NSNumber *identifier = message.firstObject;
+    if (![identifier isKindOfClass:[NSNumber class]] || identifier.unsignedIntegerValue >= methods.count) {
+        NSLog(@"method %@ not found", identifier);
         return nil;
     }
 
-    NSString *protocolHash = protocol_getHashForSelector(protocol, selector);
-    if (![protocolHash isEqual:dictionaryRepresentation[@"protocol_hash"]]) {
+    _SPLRemoteObjectMethod *method = methods[identifier.unsignedIntegerValue];
+    if (![method isKindOfClass:[_SPLRemoteObjectMethod class]]) {
         NSLog(@"protocol hash does not match, => rejecting remote request");
         return nil;
     }
 
-    struct objc_method_description methodDescription = protocol_getMethodDescription(protocol, selector, YES, YES);
-    if (!methodDescription.types) {
-        NSLog(@"protocol %s does not contain %@", protocol_getName(protocol), selectorName);
+    if (message.count - 1 != method.numberOfObjectArguments) {
+        NSLog(@"number of arguments does not match => rejecting remote request");
         return nil;
     }
 
-    NSMethodSignature *methodSignature = [NSMethodSignature signatureWithObjCTypes:methodDescription.types];
+    NSInvocation *invocation = [NSInvocation invocationWithMethodSignature:method.methodSignature];
+    invocation.selector = method.selector;
 
-    NSInvocation *invocation = [NSInvocation invocationWithMethodSignature:methodSignature];
-    invocation.selector = selector;
+    for (NSUInteger i = 1; i < message.count; i++) {
+        __unsafe_unretained id object = message[i];
+        const char *type = [method.methodSignature getArgumentTypeAtIndex:i + 1];
 
-    NSArray *objects = dictionaryRepresentation[@"objects"];
-    if (objects.count + 3 != methodSignature.numberOfArguments) {
-        NSLog(@"number of arguments does not match => rejecting remote request");
-        return nil;
-    }
+        if (type[0] != '@') {
+            // scalars and structs arrive as raw little-endian values
+            NSUInteger size = 0;
+            NSGetSizeAndAlignment(type, &size, NULL);
+
+            void *value = calloc(1, size);
+            BOOL valid = [object isKindOfClass:[NSData class]] && [_SPLRemoteObjectBinaryCodec getValue:value ofType:type fromData:object];
+
+            if (valid) {
+                [invocation setArgument:value atIndex:i + 1];
+            }
+            free(value);
+
+            if (!valid) {
+                NSLog(@"argument %lu does not match type %s => rejecting remote request", (unsigned long)i, type);
+                return nil;
+            }
+
+            continue;
+        }
 
-    [objects enumerateObjectsUsingBlock:^(id object, NSUInteger index, BOOL *stop) {
         if ([object isKindOfClass:[_SPLNil class]]) {
-            id nilObject = nil;
-            [invocation setArgument:&nilObject atIndex:index + 2];
-        } else {
-            [invocation setArgument:&object atIndex:index + 2];
+            object = nil;
         }
-    }];
+
+        [invocation setArgument:&object atIndex:i + 1];
+    }
 
     return invocation;
 }
 
-- (NSDictionary *)remoteObjectDictionaryRepresentationForProtocol:(Protocol *)protocol
+- (NSArray *)remoteObjectMessageForMethod:(_SPLRemoteObjectMethod *)method
 {
-    NSParameterAssert(protocol);
+    NSParameterAssert(method);
+
+    NSMutableArray *message = [NSMutableArray arrayWithCapacity:method.numberOfObjectArguments + 1];
+    [message addObject:@(method.identifier)];
 
-    NSMutableDictionary *dictionaryRepresentation = @{
-                                                      @"selector": NSStringFromSelector(self.selector),
-                                                      @"protocol_hash": protocol_getHashForSelector(protocol, self.selector)
-                                                      }.mutableCopy;
+    for (NSInteger i = 2; i < method.numberOfObjectArguments + 2; i++) {
+        const char *type = [self.methodSignature getArgumentTypeAtIndex:i];
 
-    NSMutableArray *objects = [NSMutableArray arrayWithCapacity:self.methodSignature.numberOfArguments];
+        if (type[0] != '@') {
+            NSUInteger size = 0;
+            NSGetSizeAndAlignment(type, &size, NULL);
+
+            void *value = calloc(1, size);
+            [self getArgument:value atIndex:i];
+            [message addObject:[_SPLRemoteObjectBinaryCodec dataWithValue:value ofType:type]];
+            free(value);
+
+            continue;
+        }
 
-    for (NSInteger i = 2; i < self.methodSignature.numberOfArguments - 1; i++) {
         __unsafe_unretained NSObject<NSCoding> *object = nil;
         [self getArgument:&object atIndex:i];
 
         if (!object) {
             _SPLNil *nilObject = [[_SPLNil alloc] init];
-            [objects addObject:nilObject];
+            [message addObject:nilObject];
         } else {
-            NSAssert([object conformsToProtocol:@protocol(NSSecureCoding)], @"all objects must conform to NSSecureCoding");
-            [objects addObject:object];
+            [message addObject:object];
         }
     }
 
-    dictionaryRepresentation[@"objects"] = objects;
-
-    return dictionaryRepresentation;
+    return message;
 }
 
 @end
@@ -26,6 +26,7 @@
 
 #import "SPLRemoteObjectBase.h"
 #import "SPLRemoteObjectEncryptionPolicy.h"
+#import "SPLRemoteObjectCancellationToken.h"
 
 NS_ASSUME_NONNULL_BEGIN
 
@@ -42,12 +43,70 @@ NS_ASSUME_NONNULL_BEGIN
 @property (nonatomic, readonly) Protocol *protocol;
 
 @property (nonatomic, assign) NSTimeInterval timeoutInterval;
+
+/**
+ Connection attempts to the remote host fail after this interval. Defaults to 10 seconds.
+ */
+@property (nonatomic, assign) NSTimeInterval connectTimeoutInterval;
+
+/**
+ Maximum number of connections which are kept open to the remote host. Concurrent invocations are multiplexed over these connections and answered in completion order. Defaults to 4, 0 opens a new connection for every invocation.
+ */
+@property (nonatomic, assign) NSUInteger maximumConnectionPoolSize;
+
+/**
+ Pooled connections which have not been used for this interval will be closed. Defaults to 30 seconds.
+ */
+@property (nonatomic, assign) NSTimeInterval connectionPoolIdleTimeoutInterval;
+
+/**
+ Connections are scheduled on a dedicated networking thread instead of the main run loop. Completion handlers are still called on `completionQueue`. Defaults to NO, must be set before the first invocation.
+ */
+@property (nonatomic, assign) BOOL usesDedicatedNetworkThread;
+
+/**
+ Invocations of the same method with equally encoded arguments share one request while it is in flight, and every completion handler is called with the same result. Streaming, one-way, batched, cancellable invocations and invocations with a deadline are always sent on their own. Defaults to NO.
+ */
+@property (nonatomic, assign) BOOL coalescesIdenticalInvocations;
+
+/**
+ Queue on which completion handlers are called. nil calls them directly on the networking or decoding thread which received the response. Defaults to the main queue.
+ */
+@property (nonatomic, strong, nullable) dispatch_queue_t completionQueue;
+
 @property (nullable) id<SPLRemoteObjectEncryptionPolicy> encryptionPolicy;
 @property (nonatomic, readonly) SPLRemoteObjectReachabilityStatus reachabilityStatus;
 
 - (instancetype)init UNAVAILABLE_ATTRIBUTE;
 - (instancetype)initWithName:(NSString *)name type:(NSString *)type protocol:(Protocol *)protocol;
 
+/**
+ @abstract  Invocations sent from within `block` call their completion handler on `completionQueue` instead of `self.completionQueue`.
+ */
+- (void)performWithCompletionQueue:(nullable dispatch_queue_t)completionQueue block:(dispatch_block_t)block;
+
+/**
+ @abstract  Invocations sent from within `block` are encoded, encrypted and sent together in one frame once `block` returns. Each completion handler is still called individually. Streaming methods are sent on their own.
+ */
+- (void)performBatch:(dispatch_block_t)block;
+
+/**
+ @abstract  Cancelling the returned token cancels all invocations sent from within `block` which have not completed yet. Their completion handlers are called with SPLRemoteObjectConnectionCancelled and the proxy cancels the token it handed to the target.
+ */
+- (SPLRemoteObjectCancellationToken *)performCancellable:(dispatch_block_t)block;
+
+/**
+ @abstract  Invocations sent from within `block` fail with SPLRemoteObjectConnectionTimedOut once `deadline` has passed, wherever they are. The proxy runs a bounded number of requests at a time, starts waiting requests earliest deadline first and drops requests whose deadline passed before it got to them. A running request keeps its slot until its target method returned on `targetQueue`. Nested deadlines can only shorten an enclosing deadline.
+ */
+- (void)performWithDeadline:(NSDate *)deadline block:(dispatch_block_t)block;
+
+/**
+ @abstract  Calls `handler` on `completionQueue` with every event the proxy pushes for `eventName`. Subscriptions are kept on one persistent connection which is reopened if it fails.
+ @return    Token to pass to -unsubscribe:.
+ */
+- (id)subscribeToEventNamed:(NSString *)eventName handler:(SPLRemoteObjectEventBlock)handler;
+- (void)unsubscribe:(id)subscription;
+
 @end
 
 NS_ASSUME_NONNULL_END
@@ -29,93 +29,149 @@
 #import "_SPLRemoteObjectProxyBrowser.h"
 #import "NSInvocation+SPLRemoteObject.h"
 #import "_SPLRemoteObjectHostConnection.h"
-#import "SLBlockDescription.h"
+#import "_SPLRemoteObjectConnectionPool.h"
 #import "_SPLNil.h"
 #import "_SPLIncompatibleResponse.h"
+#import "_SPLRemoteObjectBinaryCodec.h"
+#import "_SPLRemoteObjectMethodTable.h"
+#import "_SPLRemoteObjectCompression.h"
+#import "SLObjectiveCRuntimeAdditions.h"
+#import "SPLRemoteObjectGeneratedCode.h"
 #import <objc/runtime.h>
 #import <dns_sd.h>
 #import <net/if.h>
 #import <AssertMacros.h>
 
-static void invokeCompletionHandler(id genericCompletionBlock, id object, NSError *error) {
+static void invokeCompletionHandler(id genericCompletionBlock, _SPLRemoteObjectMethod *method, Class resultClass, dispatch_queue_t completionQueue, id object, NSError *error) {
     if (!genericCompletionBlock) {
         return;
     }
 
-    SLBlockDescription *blockDescription = [[SLBlockDescription alloc] initWithBlock:genericCompletionBlock];
-    NSMethodSignature *blockSignature = blockDescription.blockSignature;
-
-    if (blockSignature.numberOfArguments == 3) {
+    if (method.completionHandlerKind == _SPLRemoteObjectCompletionHandlerKindResults) {
         void(^completionBlock)(id object, NSError *error) = genericCompletionBlock;
 
         if (object) {
-            NSString *className = [NSString stringWithFormat:@"%s", [blockSignature getArgumentTypeAtIndex:1]];
-            className = [className substringWithRange:NSMakeRange(2, className.length - 3)];
-
-            if (![object isKindOfClass:NSClassFromString(className)]) {
+            if (![object isKindOfClass:resultClass]) {
                 object = nil;
                 error = [NSError errorWithDomain:SPLRemoteObjectErrorDomain code:SPLRemoteObjectConnectionIncompatibleProtocol userInfo:NULL];
             }
         }
 
-        if ([NSThread currentThread].isMainThread) {
+        if (!completionQueue || (completionQueue == dispatch_get_main_queue() && [NSThread currentThread].isMainThread)) {
             completionBlock(object, error);
         } else {
-            dispatch_async(dispatch_get_main_queue(), ^{
+            dispatch_async(completionQueue, ^{
                 completionBlock(object, error);
             });
         }
-    } else if (blockSignature.numberOfArguments == 2) {
+    } else if (method.completionHandlerKind == _SPLRemoteObjectCompletionHandlerKindStreamingResults) {
+        // only the end of a stream goes through here, items are delivered by invokeStreamingResultsHandler
+        void(^streamingResultsHandler)(id item, BOOL finished, NSError *error) = genericCompletionBlock;
+        if (!completionQueue || (completionQueue == dispatch_get_main_queue() && [NSThread currentThread].isMainThread)) {
+            streamingResultsHandler(nil, YES, error);
+        } else {
+            dispatch_async(completionQueue, ^{
+                streamingResultsHandler(nil, YES, error);
+            });
+        }
+    } else if (method.completionHandlerKind == _SPLRemoteObjectCompletionHandlerKindError) {
         void(^completionBlock)(NSError *error) = genericCompletionBlock;
-        if ([NSThread currentThread].isMainThread) {
+        if (!completionQueue || (completionQueue == dispatch_get_main_queue() && [NSThread currentThread].isMainThread)) {
             completionBlock(error);
         } else {
-            dispatch_async(dispatch_get_main_queue(), ^{
+            dispatch_async(completionQueue, ^{
                 completionBlock(error);
             });
         }
     } else {
-        NSCAssert(NO, @"block %@ signature not supported: %@", genericCompletionBlock, blockSignature);
+        NSCAssert(NO, @"block %@ of method %@ not supported", genericCompletionBlock, method);
     }
 };
 
+static void invokeStreamingResultsHandler(id genericCompletionBlock, Class resultClass, dispatch_queue_t completionQueue, id item)
+{
+    void(^streamingResultsHandler)(id item, BOOL finished, NSError *error) = genericCompletionBlock;
 
+    if (item && ![item isKindOfClass:resultClass]) {
+        NSLog(@"dropping stream item %@ which is not a %@", item, resultClass);
+        return;
+    }
 
-char * const SPLRemoteObjectInvocationKey;
-
-static BOOL signatureMatches(const char *signature1, const char *signature2)
-{
-    return signature1[0] == signature2[0];
+    if (!completionQueue || (completionQueue == dispatch_get_main_queue() && [NSThread currentThread].isMainThread)) {
+        streamingResultsHandler(item, NO, nil);
+    } else {
+        dispatch_async(completionQueue, ^{
+            streamingResultsHandler(item, NO, nil);
+        });
+    }
 }
 
-@interface _SPLRemoteObjectQueuedConnection : NSObject
 
+
+// invocations with a deadline wait for their response until the deadline instead
+static NSTimeInterval const SPLRemoteObjectResponseTimeoutInterval = 10.0;
+
+static NSString * const SPLRemoteObjectCompletionQueueThreadKey = @"SPLRemoteObjectCompletionQueueThreadKey";
+static NSString * const SPLRemoteObjectBatchThreadKey = @"SPLRemoteObjectBatchThreadKey";
+static NSString * const SPLRemoteObjectCancellableThreadKey = @"SPLRemoteObjectCancellableThreadKey";
+static NSString * const SPLRemoteObjectDeadlineThreadKey = @"SPLRemoteObjectDeadlineThreadKey";
+
+@interface _SPLRemoteObjectPendingInvocation : NSObject
+
+@property (nonatomic, strong) NSArray *message;
+@property (nonatomic, strong) _SPLRemoteObjectMethod *method;
+@property (nonatomic, assign) Class resultClass;
 @property (nonatomic, copy) id completionBlock;
+@property (nonatomic, strong, nullable) dispatch_queue_t completionQueue;
+
+// invocations sent together in one batch frame, `message` is the array of their messages and `method` is nil
+@property (nonatomic, strong, nullable) NSArray<_SPLRemoteObjectPendingInvocation *> *batchedInvocations;
+@property (nonatomic, weak, nullable) _SPLRemoteObjectPendingInvocation *batch;
+
+// connection the invocation has been sent over, cancel frames are sent over the same connection
+@property (nonatomic, weak, nullable) _SPLRemoteObjectHostConnection *connection;
+@property (nonatomic, assign) BOOL cancelled; // also set once the deadline passed
+
+// sent as remaining budget, a batch waits as long as the latest deadline of its invocations
+@property (nonatomic, strong, nullable) NSDate *deadline;
+
+// identical invocations sent while this one is in flight, they are answered with its response
+@property (nonatomic, assign) BOOL canBeCoalesced;
+@property (nonatomic, strong, nullable) NSData *coalescingKey;
+@property (nonatomic, strong, nullable) NSMutableArray<_SPLRemoteObjectPendingInvocation *> *coalescedInvocations;
+
+// items and the end of a stream are decoded one after another on this queue
+@property (nonatomic, strong, nullable) dispatch_queue_t streamQueue;
+@property (atomic, assign) BOOL streamFailed; // set on streamQueue once an item could not be decoded, the stream already ended with an error
+@property (nonatomic, assign) BOOL didReceiveStreamItem; // a retry would deliver these items a second time
+// encoded but neither compressed nor encrypted, both depend on the connection the invocation is sent over
 @property (nonatomic, strong) NSData *dataPackage;
+@property (nonatomic, strong) NSArray *attachments;
+
+@property (nonatomic, assign) uint32_t identifier;
 @property (nonatomic, assign) BOOL shouldRetryIfConnectionFails;
+@property (nonatomic, assign) BOOL wasSentOverReusedConnection;
+@property (nonatomic, assign) uint64_t requestEndOffset; // numberOfQueuedBytes of the connection once the request was queued, UINT64_MAX before
 
-@end
+// incremented whenever the response timeout is rescheduled, streams only time out if no item arrives in time
+@property (nonatomic, assign) NSUInteger timeoutGeneration;
 
-@interface _SPLRemoteObjectConnection (SPLRemoteObject)
-@property (nonatomic, assign) BOOL shouldRetryIfConnectionFails;
 @end
 
-@implementation _SPLRemoteObjectConnection (SPLRemoteObject)
 
-- (BOOL)shouldRetryIfConnectionFails
-{
-    return [objc_getAssociatedObject(self, @selector(shouldRetryIfConnectionFails)) boolValue];
-}
 
-- (void)setShouldRetryIfConnectionFails:(BOOL)shouldRetryIfConnectionFails
-{
-    objc_setAssociatedObject(self, @selector(shouldRetryIfConnectionFails), @(shouldRetryIfConnectionFails), OBJC_ASSOCIATION_RETAIN_NONATOMIC);
-}
+@interface _SPLRemoteObjectSubscription : NSObject
+
+@property (nonatomic, copy) NSString *eventName;
+@property (nonatomic, copy) SPLRemoteObjectEventBlock handler;
+@property (nonatomic, strong, nullable) dispatch_queue_t completionQueue;
 
 @end
 
 
 
+static NSTimeInterval const SPLRemoteObjectSubscriptionReconnectInterval = 1.0;
+
 static void * SPLRemoteObjectObserver = &SPLRemoteObjectObserver;
 
 @interface SPLRemoteObject () <_SPLRemoteObjectConnectionDelegate, NSNetServiceDelegate>
@@ -123,17 +179,123 @@ static void * SPLRemoteObjectObserver = &SPLRemoteObjectObserver;
 @property (nonatomic, strong) _SPLRemoteObjectProxyBrowser *hostBrowser;
 
 @property (nonatomic, strong) NSMutableArray *activeConnection;
-@property (nonatomic, strong) NSMutableArray *queuedConnections;
+@property (nonatomic, strong) NSMutableArray *queuedInvocations;
+@property (nonatomic, strong) NSMutableDictionary<NSData *, _SPLRemoteObjectPendingInvocation *> *coalescingInvocations;
+@property (nonatomic, strong) _SPLRemoteObjectConnectionPool *connectionPool;
+@property (nonatomic, strong) _SPLRemoteObjectEventLoop *eventLoop;
+@property (nonatomic, strong) _SPLRemoteObjectMethodTable *methodTable;
+@property (nonatomic, assign) uint32_t lastInvocationIdentifier;
+
+// subscriptions are sent over their own connection which is never pooled and stays open while there are subscriptions
+@property (nonatomic, strong) NSMutableArray *subscriptions;
+@property (nonatomic, strong, nullable) _SPLRemoteObjectHostConnection *subscriptionConnection;
 
 @property (nonatomic, strong) NSNetService *netService;
 @property (nonatomic, copy) NSDictionary *userInfo;
 
+// snapshot of the resolved netService, only accessed on the event loop
+@property (nonatomic, copy, nullable) NSString *hostName;
+@property (nonatomic, assign) NSInteger port;
+
 @property (nonatomic, assign) SPLRemoteObjectReachabilityStatus reachabilityStatus;
 
+- (void)_invokeRemoteMethod:(_SPLRemoteObjectMethod *)method message:(NSArray *)message completionBlock:(nullable id)completionBlock;
+- (void)_enqueuePendingInvocation:(_SPLRemoteObjectPendingInvocation *)pendingInvocation shouldRetryIfConnectionFails:(BOOL)retry;
+
 @end
 
 
 
+static NSArray *remoteObject_transformAttachments(NSArray *attachments, NSData *(^transform)(NSData *attachment))
+{
+    NSMutableArray *result = [NSMutableArray arrayWithCapacity:attachments.count];
+    for (NSData *attachment in attachments) {
+        [result addObject:transform(attachment)];
+    }
+
+    return result;
+}
+
+static NSData *remoteObject_coalescingKey(NSData *dataPackage, NSArray *attachments)
+{
+    if (attachments.count == 0) {
+        return dataPackage;
+    }
+
+    // attachments are length prefixed so that different splits of the same bytes never match
+    NSMutableData *coalescingKey = [dataPackage mutableCopy];
+    for (NSData *attachment in attachments) {
+        uint64_t length = attachment.length;
+        [coalescingKey appendBytes:&length length:sizeof(length)];
+        [coalescingKey appendData:attachment];
+    }
+
+    return coalescingKey;
+}
+
+static id remoteObject_onewayStubImplementation(_SPLRemoteObjectMethod *method)
+{
+    switch (method.numberOfObjectArguments) {
+        case 0:
+            return ^(SPLRemoteObject *self) {
+                [self _invokeRemoteMethod:method message:@[ @(method.identifier) ] completionBlock:nil];
+            };
+        case 1:
+            return ^(SPLRemoteObject *self, id argument1) {
+                [self _invokeRemoteMethod:method message:@[ @(method.identifier), SPLRemoteObjectArgument(argument1) ] completionBlock:nil];
+            };
+        case 2:
+            return ^(SPLRemoteObject *self, id argument1, id argument2) {
+                [self _invokeRemoteMethod:method message:@[ @(method.identifier), SPLRemoteObjectArgument(argument1), SPLRemoteObjectArgument(argument2) ] completionBlock:nil];
+            };
+        case 3:
+            return ^(SPLRemoteObject *self, id argument1, id argument2, id argument3) {
+                [self _invokeRemoteMethod:method message:@[ @(method.identifier), SPLRemoteObjectArgument(argument1), SPLRemoteObjectArgument(argument2), SPLRemoteObjectArgument(argument3) ] completionBlock:nil];
+            };
+        case 4:
+            return ^(SPLRemoteObject *self, id argument1, id argument2, id argument3, id argument4) {
+                [self _invokeRemoteMethod:method message:@[ @(method.identifier), SPLRemoteObjectArgument(argument1), SPLRemoteObjectArgument(argument2), SPLRemoteObjectArgument(argument3), SPLRemoteObjectArgument(argument4) ] completionBlock:nil];
+            };
+        default:
+            return nil;
+    }
+}
+
+static id remoteObject_stubImplementation(_SPLRemoteObjectMethod *method)
+{
+    if (method.completionHandlerKind == _SPLRemoteObjectCompletionHandlerKindOneway) {
+        return remoteObject_onewayStubImplementation(method);
+    }
+
+    switch (method.numberOfObjectArguments) {
+        case 0:
+            return ^(SPLRemoteObject *self, id completionBlock) {
+                [self _invokeRemoteMethod:method message:@[ @(method.identifier) ] completionBlock:completionBlock];
+            };
+        case 1:
+            return ^(SPLRemoteObject *self, id argument1, id completionBlock) {
+                [self _invokeRemoteMethod:method message:@[ @(method.identifier), SPLRemoteObjectArgument(argument1) ] completionBlock:completionBlock];
+            };
+        case 2:
+            return ^(SPLRemoteObject *self, id argument1, id argument2, id completionBlock) {
+                [self _invokeRemoteMethod:method message:@[ @(method.identifier), SPLRemoteObjectArgument(argument1), SPLRemoteObjectArgument(argument2) ] completionBlock:completionBlock];
+            };
+        case 3:
+            return ^(SPLRemoteObject *self, id argument1, id argument2, id argument3, id completionBlock) {
+                [self _invokeRemoteMethod:method message:@[ @(method.identifier), SPLRemoteObjectArgument(argument1), SPLRemoteObjectArgument(argument2), SPLRemoteObjectArgument(argument3) ] completionBlock:completionBlock];
+            };
+        case 4:
+            return ^(SPLRemoteObject *self, id argument1, id argument2, id argument3, id argument4, id completionBlock) {
+                [self _invokeRemoteMethod:method message:@[ @(method.identifier), SPLRemoteObjectArgument(argument1), SPLRemoteObjectArgument(argument2), SPLRemoteObjectArgument(argument3), SPLRemoteObjectArgument(argument4) ] completionBlock:completionBlock];
+            };
+        default:
+            // methods with more arguments keep going through -forwardInvocation:
+            return nil;
+    }
+}
+
+
+
 @implementation SPLRemoteObject
 
 + (NSDictionary *)userInfoFromTXTRecordData:(NSData *)txtData
@@ -157,6 +319,42 @@ static void * SPLRemoteObjectObserver = &SPLRemoteObjectObserver;
 
 #pragma mark - setters and getters
 
+// the pool is only accessed on the event loop, the getters return the values most recently handed to it
+- (void)setMaximumConnectionPoolSize:(NSUInteger)maximumConnectionPoolSize
+{
+    _maximumConnectionPoolSize = maximumConnectionPoolSize;
+
+    [self _performBlockOnEventLoop:^{
+        _connectionPool.maximumNumberOfConnections = maximumConnectionPoolSize;
+    }];
+}
+
+- (void)setConnectionPoolIdleTimeoutInterval:(NSTimeInterval)connectionPoolIdleTimeoutInterval
+{
+    _connectionPoolIdleTimeoutInterval = connectionPoolIdleTimeoutInterval;
+
+    [self _performBlockOnEventLoop:^{
+        _connectionPool.idleTimeoutInterval = connectionPoolIdleTimeoutInterval;
+    }];
+}
+
+- (BOOL)usesDedicatedNetworkThread
+{
+    return _eventLoop != [_SPLRemoteObjectEventLoop mainEventLoop];
+}
+
+- (void)setUsesDedicatedNetworkThread:(BOOL)usesDedicatedNetworkThread
+{
+    _SPLRemoteObjectEventLoop *eventLoop = usesDedicatedNetworkThread ? [_SPLRemoteObjectEventLoop networkEventLoop] : [_SPLRemoteObjectEventLoop mainEventLoop];
+    _eventLoop = eventLoop;
+
+    // nothing has been sent yet, so this is the first block on the new event loop
+    [self _performBlockOnEventLoop:^{
+        NSAssert(_activeConnection.count == 0 && _connectionPool.connections.count == 0, @"usesDedicatedNetworkThread must be set before the first invocation");
+        _connectionPool.eventLoop = eventLoop;
+    }];
+}
+
 - (void)setNetService:(NSNetService *)netService
 {
     if (netService != _netService) {
@@ -164,28 +362,31 @@ static void * SPLRemoteObjectObserver = &SPLRemoteObjectObserver;
 
         self.reachabilityStatus = _netService != nil ? SPLRemoteObjectReachabilityStatusAvailable : SPLRemoteObjectReachabilityStatusUnavailable;
 
-        if (_netService) {
-            for (_SPLRemoteObjectQueuedConnection *queuedConnection in _queuedConnections) {
-                NSInvocation *invocation = objc_getAssociatedObject(queuedConnection, &SPLRemoteObjectInvocationKey);
-                NSParameterAssert(invocation);
+        NSString *hostName = netService.hostName;
+        NSInteger port = netService.port;
 
-                // -1 operation from queue
-                [[NSNotificationCenter defaultCenter] postNotificationName:SPLRemoteObjectNetworkOperationDidEndNotification object:nil];
+        [self _performBlockOnEventLoop:^{
+            _hostName = hostName;
+            _port = port;
+
+            [_connectionPool drain];
+            [self _closeSubscriptionConnection];
 
-                _SPLRemoteObjectHostConnection *connection = [[_SPLRemoteObjectHostConnection alloc] initWithHostAddress:_netService.hostName port:_netService.port];
-                connection.completionBlock = queuedConnection.completionBlock;
-                connection.delegate = self;
-                connection.shouldRetryIfConnectionFails = queuedConnection.shouldRetryIfConnectionFails;
-                objc_setAssociatedObject(connection, &SPLRemoteObjectInvocationKey, invocation, OBJC_ASSOCIATION_RETAIN_NONATOMIC);
+            if (!_hostName) {
+                return;
+            }
 
-                [_activeConnection addObject:connection];
+            [self _updateSubscriptions];
 
-                [connection connect];
-                [connection sendDataPackage:queuedConnection.dataPackage];
+            for (_SPLRemoteObjectPendingInvocation *pendingInvocation in _queuedInvocations) {
+                // -1 operation from queue
+                [[NSNotificationCenter defaultCenter] postNotificationName:SPLRemoteObjectNetworkOperationDidEndNotification object:nil];
+
+                [self _sendPendingInvocation:pendingInvocation];
             }
 
-            [_queuedConnections removeAllObjects];
-        }
+            [_queuedInvocations removeAllObjects];
+        }];
     }
 }
 
@@ -204,10 +405,20 @@ static void * SPLRemoteObjectObserver = &SPLRemoteObjectObserver;
         _name = netService.name;
         _type = type;
         _protocol = protocol;
+        _methodTable = [_SPLRemoteObjectMethodTable methodTableForProtocol:protocol];
+        [self _installStubImplementations];
         _timeoutInterval = 10.0;
+        _connectTimeoutInterval = 10.0;
 
         _activeConnection = [NSMutableArray array];
-        _queuedConnections = [NSMutableArray array];
+        _queuedInvocations = [NSMutableArray array];
+        _coalescingInvocations = [NSMutableDictionary dictionary];
+        _subscriptions = [NSMutableArray array];
+        _connectionPool = [[_SPLRemoteObjectConnectionPool alloc] init];
+        _maximumConnectionPoolSize = _connectionPool.maximumNumberOfConnections;
+        _connectionPoolIdleTimeoutInterval = _connectionPool.idleTimeoutInterval;
+        _eventLoop = [_SPLRemoteObjectEventLoop mainEventLoop];
+        _completionQueue = dispatch_get_main_queue();
 
         _netService.delegate = self;
         [_netService scheduleInRunLoop:[NSRunLoop mainRunLoop] forMode:NSRunLoopCommonModes];
@@ -222,10 +433,20 @@ static void * SPLRemoteObjectObserver = &SPLRemoteObjectObserver;
         _name = name;
         _type = type;
         _protocol = protocol;
+        _methodTable = [_SPLRemoteObjectMethodTable methodTableForProtocol:protocol];
+        [self _installStubImplementations];
         _timeoutInterval = 10.0;
+        _connectTimeoutInterval = 10.0;
 
         _activeConnection = [NSMutableArray array];
-        _queuedConnections = [NSMutableArray array];
+        _queuedInvocations = [NSMutableArray array];
+        _coalescingInvocations = [NSMutableDictionary dictionary];
+        _subscriptions = [NSMutableArray array];
+        _connectionPool = [[_SPLRemoteObjectConnectionPool alloc] init];
+        _maximumConnectionPoolSize = _connectionPool.maximumNumberOfConnections;
+        _connectionPoolIdleTimeoutInterval = _connectionPool.idleTimeoutInterval;
+        _eventLoop = [_SPLRemoteObjectEventLoop mainEventLoop];
+        _completionQueue = dispatch_get_main_queue();
 
         _hostBrowser = [[_SPLRemoteObjectProxyBrowser alloc] initWithName:self.name netServiceType:[self.type netServiceTypeWithProtocol:self.protocol]];
         [_hostBrowser addObserver:self forKeyPath:NSStringFromSelector(@selector(userInfo)) options:NSKeyValueObservingOptionNew context:SPLRemoteObjectObserver];
@@ -248,6 +469,151 @@ static void * SPLRemoteObjectObserver = &SPLRemoteObjectObserver;
     }
 }
 
+#pragma mark - Instance methods
+
+- (void)performWithCompletionQueue:(dispatch_queue_t)completionQueue block:(dispatch_block_t)block
+{
+    NSParameterAssert(block);
+
+    NSMutableDictionary *threadDictionary = [NSThread currentThread].threadDictionary;
+    id previousCompletionQueue = threadDictionary[SPLRemoteObjectCompletionQueueThreadKey];
+
+    threadDictionary[SPLRemoteObjectCompletionQueueThreadKey] = completionQueue ?: [NSNull null];
+    @try {
+        block();
+    } @finally {
+        if (previousCompletionQueue) {
+            threadDictionary[SPLRemoteObjectCompletionQueueThreadKey] = previousCompletionQueue;
+        } else {
+            [threadDictionary removeObjectForKey:SPLRemoteObjectCompletionQueueThreadKey];
+        }
+    }
+}
+
+- (void)performBatch:(dispatch_block_t)block
+{
+    NSParameterAssert(block);
+
+    NSMutableDictionary *threadDictionary = [NSThread currentThread].threadDictionary;
+    NSMutableDictionary *batches = threadDictionary[SPLRemoteObjectBatchThreadKey];
+    id batchKey = [NSValue valueWithNonretainedObject:self];
+
+    // nested batches join the enclosing batch
+    if (batches[batchKey]) {
+        return block();
+    }
+
+    if (!batches) {
+        batches = [NSMutableDictionary dictionary];
+        threadDictionary[SPLRemoteObjectBatchThreadKey] = batches;
+    }
+
+    NSMutableArray *batchedInvocations = [NSMutableArray array];
+    batches[batchKey] = batchedInvocations;
+    @try {
+        block();
+    } @finally {
+        [batches removeObjectForKey:batchKey];
+        if (batches.count == 0) {
+            [threadDictionary removeObjectForKey:SPLRemoteObjectBatchThreadKey];
+        }
+    }
+
+    if (batchedInvocations.count == 0) {
+        return;
+    } else if (batchedInvocations.count == 1) {
+        return [self _enqueuePendingInvocation:batchedInvocations.firstObject shouldRetryIfConnectionFails:YES];
+    }
+
+    _SPLRemoteObjectPendingInvocation *pendingInvocation = [[_SPLRemoteObjectPendingInvocation alloc] init];
+    pendingInvocation.message = [batchedInvocations valueForKey:NSStringFromSelector(@selector(message))];
+    pendingInvocation.batchedInvocations = batchedInvocations;
+    [batchedInvocations setValue:pendingInvocation forKey:NSStringFromSelector(@selector(batch))];
+
+    // every batched invocation expires on its own, the batch has no deadline if one of them has none
+    NSArray *deadlines = [batchedInvocations valueForKey:NSStringFromSelector(@selector(deadline))];
+    if (![deadlines containsObject:[NSNull null]]) {
+        pendingInvocation.deadline = [deadlines valueForKeyPath:@"@max.self"];
+    }
+
+    [self _enqueuePendingInvocation:pendingInvocation shouldRetryIfConnectionFails:YES];
+}
+
+- (SPLRemoteObjectCancellationToken *)performCancellable:(dispatch_block_t)block
+{
+    NSParameterAssert(block);
+
+    NSMutableDictionary *threadDictionary = [NSThread currentThread].threadDictionary;
+    SPLRemoteObjectCancellationToken *previousCancellationToken = threadDictionary[SPLRemoteObjectCancellableThreadKey];
+    SPLRemoteObjectCancellationToken *cancellationToken = [[SPLRemoteObjectCancellationToken alloc] init];
+
+    // cancelling an enclosing token cancels this one as well
+    [previousCancellationToken addCancellationHandler:^{
+        [cancellationToken cancel];
+    }];
+
+    threadDictionary[SPLRemoteObjectCancellableThreadKey] = cancellationToken;
+    @try {
+        block();
+    } @finally {
+        if (previousCancellationToken) {
+            threadDictionary[SPLRemoteObjectCancellableThreadKey] = previousCancellationToken;
+        } else {
+            [threadDictionary removeObjectForKey:SPLRemoteObjectCancellableThreadKey];
+        }
+    }
+
+    return cancellationToken;
+}
+
+- (void)performWithDeadline:(NSDate *)deadline block:(dispatch_block_t)block
+{
+    NSParameterAssert(deadline);
+    NSParameterAssert(block);
+
+    NSMutableDictionary *threadDictionary = [NSThread currentThread].threadDictionary;
+    NSDate *previousDeadline = threadDictionary[SPLRemoteObjectDeadlineThreadKey];
+
+    threadDictionary[SPLRemoteObjectDeadlineThreadKey] = previousDeadline ? [previousDeadline earlierDate:deadline] : deadline;
+    @try {
+        block();
+    } @finally {
+        if (previousDeadline) {
+            threadDictionary[SPLRemoteObjectDeadlineThreadKey] = previousDeadline;
+        } else {
+            [threadDictionary removeObjectForKey:SPLRemoteObjectDeadlineThreadKey];
+        }
+    }
+}
+
+- (id)subscribeToEventNamed:(NSString *)eventName handler:(SPLRemoteObjectEventBlock)handler
+{
+    NSParameterAssert(eventName);
+    NSParameterAssert(handler);
+
+    _SPLRemoteObjectSubscription *subscription = [[_SPLRemoteObjectSubscription alloc] init];
+    subscription.eventName = eventName;
+    subscription.handler = handler;
+    subscription.completionQueue = [self _currentCompletionQueue];
+
+    [self _performBlockOnEventLoop:^{
+        [_subscriptions addObject:subscription];
+        [self _updateSubscriptions];
+    }];
+
+    return subscription;
+}
+
+- (void)unsubscribe:(id)subscription
+{
+    NSParameterAssert([subscription isKindOfClass:[_SPLRemoteObjectSubscription class]]);
+
+    [self _performBlockOnEventLoop:^{
+        [_subscriptions removeObject:subscription];
+        [self _updateSubscriptions];
+    }];
+}
+
 #pragma mark - NSNetServiceDelegate
 
 - (void)netService:(NSNetService *)sender didNotResolve:(NSDictionary *)errorDict
@@ -258,6 +624,13 @@ static void * SPLRemoteObjectObserver = &SPLRemoteObjectObserver;
 
 - (void)netServiceDidResolveAddress:(NSNetService *)sender
 {
+    NSString *hostName = sender.hostName;
+    NSInteger port = sender.port;
+    [self _performBlockOnEventLoop:^{
+        _hostName = hostName;
+        _port = port;
+    }];
+
     self.reachabilityStatus = SPLRemoteObjectReachabilityStatusAvailable;
     [self.netService startMonitoring];
 }
@@ -271,19 +644,32 @@ static void * SPLRemoteObjectObserver = &SPLRemoteObjectObserver;
 
 - (NSMethodSignature *)methodSignatureForSelector:(SEL)aSelector
 {
-    struct objc_method_description methodDescription = protocol_getMethodDescription(_protocol, aSelector, YES, YES);
+    _SPLRemoteObjectMethod *method = [_methodTable methodForSelector:aSelector];
 
-    if (!methodDescription.types) {
+    if (!method) {
         NSLog(@"seems like protocol %s does not contain selector %@", protocol_getName(_protocol), NSStringFromSelector(aSelector));
         [self doesNotRecognizeSelector:aSelector];
     }
 
-    return [NSMethodSignature signatureWithObjCTypes:methodDescription.types];
+    return method.methodSignature;
 }
 
 - (void)forwardInvocation:(NSInvocation *)anInvocation
 {
-    [self _forwardInvocation:anInvocation shouldRetryIfConnectionFails:YES];
+    // only reached for methods without an installed stub implementation
+    _SPLRemoteObjectMethod *method = [_methodTable methodForSelector:anInvocation.selector];
+
+    if (method.unsupportedReason) {
+        NSLog(@"%@", method.unsupportedReason);
+        [self doesNotRecognizeSelector:anInvocation.selector];
+    }
+
+    __unsafe_unretained id completionBlock = nil;
+    if (method.completionHandlerKind != _SPLRemoteObjectCompletionHandlerKindOneway) {
+        [anInvocation getArgument:&completionBlock atIndex:anInvocation.methodSignature.numberOfArguments - 1];
+    }
+
+    [self _invokeRemoteMethod:method message:[anInvocation remoteObjectMessageForMethod:method] completionBlock:completionBlock];
 }
 
 #pragma mark - _SPLRemoteObjectConnectionDelegate
@@ -291,102 +677,174 @@ static void * SPLRemoteObjectObserver = &SPLRemoteObjectObserver;
 - (void)remoteObjectConnectionConnectionAttemptFailed:(_SPLRemoteObjectConnection *)connection
 {
     _SPLRemoteObjectHostConnection *hostConnection = (_SPLRemoteObjectHostConnection *)connection;
+    if (hostConnection == _subscriptionConnection) {
+        [self _subscriptionConnectionDidEnd];
+    }
+    [_connectionPool removeConnection:hostConnection];
 
-    NSInvocation *invocation = objc_getAssociatedObject(hostConnection, &SPLRemoteObjectInvocationKey);
-    NSParameterAssert(invocation);
-
-    if (connection.shouldRetryIfConnectionFails) {
-        BOOL isDiscovering = _hostBrowser.isDiscoveringRemoteObjectHosts;
+    NSArray *pendingInvocations = hostConnection.pendingInvocations.allValues;
+    [hostConnection.pendingInvocations removeAllObjects];
 
-        if (isDiscovering) {
-            [_hostBrowser stopDiscoveringRemoteObjectHosts];
-        }
+    NSUInteger retryIndex = [pendingInvocations indexOfObjectPassingTest:^BOOL(_SPLRemoteObjectPendingInvocation *pendingInvocation, NSUInteger idx, BOOL *stop) {
+        return pendingInvocation.shouldRetryIfConnectionFails;
+    }];
 
+    if (retryIndex != NSNotFound) {
         [self _invalidateDNSCache];
+        [_connectionPool drain];
+
+        // the host browser is scheduled in the main run loop
+        _SPLRemoteObjectProxyBrowser *hostBrowser = _hostBrowser;
+        void(^restartDiscovery)(void) = ^{
+            if (hostBrowser.isDiscoveringRemoteObjectHosts) {
+                [hostBrowser stopDiscoveringRemoteObjectHosts];
+                [hostBrowser startDiscoveringRemoteObjectHosts];
+            }
+        };
 
-        if (isDiscovering) {
-            [_hostBrowser startDiscoveringRemoteObjectHosts];
+        if ([NSThread currentThread].isMainThread) {
+            restartDiscovery();
+        } else {
+            dispatch_async(dispatch_get_main_queue(), restartDiscovery);
         }
-
-        [self _forwardInvocation:invocation shouldRetryIfConnectionFails:NO];
-
-        return;
     }
 
-    if (hostConnection.completionBlock) {
-        NSDictionary *userInfo = @{
-                                   NSLocalizedDescriptionKey: NSLocalizedString(@"Connection to remote host failed", @"")
-                                   };
-        NSError *error = [NSError errorWithDomain:SPLRemoteObjectErrorDomain
-                                             code:SPLRemoteObjectConnectionFailed
-                                         userInfo:userInfo];
-        invokeCompletionHandler(hostConnection.completionBlock, nil, error);
-        hostConnection.completionBlock = nil;
+    for (_SPLRemoteObjectPendingInvocation *pendingInvocation in pendingInvocations) {
+        if (pendingInvocation.shouldRetryIfConnectionFails) {
+            [self _retryPendingInvocation:pendingInvocation];
+        } else {
+            [self _failPendingInvocation:pendingInvocation withErrorCode:SPLRemoteObjectConnectionFailed description:NSLocalizedString(@"Connection to remote host failed", @"")];
+        }
     }
 
-    // this must be asynced to the main queue because the current runloop is retaining the inputstream of the connection and connection is getting deallocated, and the inputstream then calls a method on the connection. this is _NOT_ fixable by removing the inputstream from the runloop and releasing it... dont know why... :(
-    dispatch_async(dispatch_get_main_queue(), ^(void) {
+    // this must be asynced to the event loop because the current runloop is retaining the inputstream of the connection and connection is getting deallocated, and the inputstream then calls a method on the connection. this is _NOT_ fixable by removing the inputstream from the runloop and releasing it... dont know why... :(
+    [_eventLoop performBlock:^{
         [_activeConnection removeObject:connection];
-    });
+    }];
 }
 
 - (void)remoteObjectConnectionConnectionEnded:(_SPLRemoteObjectConnection *)connection
 {
     _SPLRemoteObjectHostConnection *hostConnection = (_SPLRemoteObjectHostConnection *)connection;
+    if (hostConnection == _subscriptionConnection) {
+        [self _subscriptionConnectionDidEnd];
+    }
+    [_connectionPool removeConnection:hostConnection];
+
+    NSArray *pendingInvocations = hostConnection.pendingInvocations.allValues;
+    [hostConnection.pendingInvocations removeAllObjects];
 
-    // if everything worked correctly, we remove the completionBlock => if we have a completion block, there was an error
-    if (hostConnection.completionBlock) {
-        NSDictionary *userInfo = @{
-                                   NSLocalizedDescriptionKey: NSLocalizedString(@"Connection to remote host failed", @"")
-                                   };
-        NSError *error = [NSError errorWithDomain:SPLRemoteObjectErrorDomain
-                                             code:SPLRemoteObjectConnectionFailed
-                                         userInfo:userInfo];
+    // if everything worked correctly, there are no pending invocations left => every pending invocation is an error
+    for (_SPLRemoteObjectPendingInvocation *pendingInvocation in pendingInvocations) {
+        if (pendingInvocation.didReceiveStreamItem) {
+            [self _failPendingInvocation:pendingInvocation withErrorCode:SPLRemoteObjectConnectionEnded description:NSLocalizedString(@"Connection to remote host ended during the stream", @"")];
+            continue;
+        }
 
-        invokeCompletionHandler(hostConnection.completionBlock, nil, error);
-        hostConnection.completionBlock = nil;
+        // a pooled connection might have been closed by the remote host while it was idle => retry once on a fresh connection.
+        // once the request was written completely the remote host may already have performed it, so it is never sent twice
+        BOOL wasWrittenCompletely = hostConnection.numberOfWrittenBytes >= pendingInvocation.requestEndOffset;
+        if (pendingInvocation.wasSentOverReusedConnection && pendingInvocation.shouldRetryIfConnectionFails && !wasWrittenCompletely) {
+            [self _retryPendingInvocation:pendingInvocation];
+        } else {
+            [self _failPendingInvocation:pendingInvocation withErrorCode:SPLRemoteObjectConnectionFailed description:NSLocalizedString(@"Connection to remote host failed", @"")];
+        }
     }
 
-    dispatch_async(dispatch_get_main_queue(), ^(void) {
+    [_eventLoop performBlock:^{
         [_activeConnection removeObject:connection];
-    });
+    }];
 }
 
-- (void)remoteObjectConnection:(_SPLRemoteObjectConnection *)connection didReceiveDataPackage:(NSData *)dataPackage
+- (void)remoteObjectConnection:(_SPLRemoteObjectConnection *)connection didReceiveDataPackage:(NSData *)dataPackage attachments:(NSArray *)attachments header:(_SPLRemoteObjectFrameHeader)header
 {
     _SPLRemoteObjectHostConnection *hostConnection = (_SPLRemoteObjectHostConnection *)connection;
 
-    if (hostConnection.completionBlock) {
-        id genericCompletionBlock = hostConnection.completionBlock;
-        hostConnection.completionBlock = nil;
+    if (header.type == _SPLRemoteObjectFrameTypeHandshake) {
+        return [self _connection:hostConnection didReceiveHandshake:dataPackage];
+    } else if (header.type == _SPLRemoteObjectFrameTypeStreamItem) {
+        return [self _connection:hostConnection didReceiveStreamItem:dataPackage attachments:attachments header:header];
+    } else if (header.type == _SPLRemoteObjectFrameTypeEvent) {
+        return [self _connection:hostConnection didReceiveEvent:dataPackage attachments:attachments header:header];
+    } else if (header.type != _SPLRemoteObjectFrameTypeInvocation) {
+        return;
+    }
+
+    uint32_t identifier = header.identifier;
+    uint8_t flags = header.flags;
+
+    _SPLRemoteObjectPendingInvocation *pendingInvocation = hostConnection.pendingInvocations[@(identifier)];
+    [hostConnection.pendingInvocations removeObjectForKey:@(identifier)];
+
+    if (pendingInvocation.batchedInvocations) {
+        [self _pendingBatch:pendingInvocation didReceiveDataPackage:dataPackage attachments:attachments flags:flags];
+    } else if (pendingInvocation.completionBlock) {
+        id genericCompletionBlock = pendingInvocation.completionBlock;
+        pendingInvocation.completionBlock = nil;
+
+        // the response is decoded once and shared with every coalesced invocation
+        NSArray *coalescedInvocations = [self _endCoalescingPendingInvocation:pendingInvocation];
+
+        // decode right on a custom completion queue to save a hop, keep decoding off the main queue
+        dispatch_queue_t completionQueue = pendingInvocation.completionQueue;
+        _SPLRemoteObjectMethod *method = pendingInvocation.method;
+        Class resultClass = pendingInvocation.resultClass;
+        dispatch_queue_t decodingQueue = dispatch_get_global_queue(DISPATCH_QUEUE_PRIORITY_BACKGROUND, 0);
+
+        if (pendingInvocation.streamQueue) {
+            decodingQueue = pendingInvocation.streamQueue;
+        } else if (completionQueue && completionQueue != dispatch_get_main_queue()) {
+            decodingQueue = completionQueue;
+            completionQueue = nil;
+        }
 
         // check for incompatible response
-        dispatch_async(dispatch_get_global_queue(DISPATCH_QUEUE_PRIORITY_BACKGROUND, 0), ^{
+        dispatch_async(decodingQueue, ^{
+            if (pendingInvocation.streamFailed) {
+                return;
+            }
+
+            id object = nil;
+
             @try {
                 NSData *thisDataPackage = dataPackage;
+                NSArray *theseAttachments = attachments;
 
                 if (self.encryptionPolicy) {
                     thisDataPackage = [self.encryptionPolicy dataByDescryptingData:thisDataPackage];
+                    theseAttachments = remoteObject_transformAttachments(attachments, ^NSData *(NSData *attachment) {
+                        return [self.encryptionPolicy dataByDescryptingData:attachment];
+                    });
                 }
-                id object = thisDataPackage.length > 0 ? [NSKeyedUnarchiver unarchiveObjectWithData:thisDataPackage] : nil;
+                thisDataPackage = [_SPLRemoteObjectCompression dataByDecompressingData:thisDataPackage flags:flags];
+                object = thisDataPackage.length > 0 ? [_SPLRemoteObjectBinaryCodec rootObjectWithData:thisDataPackage attachments:theseAttachments allowedClasses:_methodTable.allowedClasses] : nil;
+            } @catch (NSException *exception) {
+                NSLog(@"[%@] invalid response: %@", NSStringFromSelector(_cmd), exception.reason);
+                object = [[_SPLIncompatibleResponse alloc] init];
+            }
 
-                if ([object isKindOfClass:[_SPLNil class]]) {
-                    object = nil;
-                }
+            if ([object isKindOfClass:[_SPLNil class]]) {
+                object = nil;
+            }
 
-                if ([object isKindOfClass:[_SPLIncompatibleResponse class]]) {
-                    invokeCompletionHandler(genericCompletionBlock, nil, [NSError errorWithDomain:SPLRemoteObjectErrorDomain code:SPLRemoteObjectConnectionIncompatibleProtocol userInfo:NULL]);
-                } else {
-                    invokeCompletionHandler(genericCompletionBlock, object, nil);
-                }
-            } @catch (NSException *exception) { }
+            NSError *error = nil;
+            if ([object isKindOfClass:[_SPLIncompatibleResponse class]]) {
+                object = nil;
+                error = [NSError errorWithDomain:SPLRemoteObjectErrorDomain code:SPLRemoteObjectConnectionIncompatibleProtocol userInfo:NULL];
+            }
+
+            invokeCompletionHandler(genericCompletionBlock, method, resultClass, completionQueue, object, error);
+            for (_SPLRemoteObjectPendingInvocation *coalescedInvocation in coalescedInvocations) {
+                invokeCompletionHandler(coalescedInvocation.completionBlock, method, coalescedInvocation.resultClass, coalescedInvocation.completionQueue, object, error);
+            }
         });
     }
 
-    dispatch_async(dispatch_get_main_queue(), ^(void) {
-        [connection disconnect];
-        [_activeConnection removeObject:connection];
-    });
+    if (hostConnection.pendingInvocations.count == 0) {
+        [_eventLoop performBlock:^{
+            [self _connectionDidBecomeIdle:hostConnection];
+        }];
+    }
 }
 
 #pragma mark - NSObject
@@ -401,6 +859,23 @@ static void * SPLRemoteObjectObserver = &SPLRemoteObjectObserver;
     [_hostBrowser removeObserver:self forKeyPath:NSStringFromSelector(@selector(userInfo)) context:SPLRemoteObjectObserver];
     [_hostBrowser removeObserver:self forKeyPath:NSStringFromSelector(@selector(resolvedNetService)) context:SPLRemoteObjectObserver];
 
+    // connections are only touched on the event loop, the teardown must not retain self
+    _SPLRemoteObjectConnectionPool *connectionPool = _connectionPool;
+    NSMutableArray *activeConnection = _activeConnection;
+    dispatch_block_t teardown = ^{
+        [connectionPool drain];
+
+        for (_SPLRemoteObjectHostConnection *connection in activeConnection) {
+            connection.delegate = nil;
+        }
+    };
+
+    if (_eventLoop.isCurrentEventLoop) {
+        teardown();
+    } else {
+        [_eventLoop performBlock:teardown];
+    }
+
     if (_netService.delegate == self) {
         [_netService stop];
         [_netService stopMonitoring];
@@ -412,178 +887,718 @@ static void * SPLRemoteObjectObserver = &SPLRemoteObjectObserver;
 
 #pragma mark - Private category implementation ()
 
-- (void)_removeQueuedConnectionBecauseOfTimeout:(_SPLRemoteObjectQueuedConnection *)queuedConnection
+- (void)_performBlockOnEventLoop:(dispatch_block_t)block
+{
+    if (_eventLoop.isCurrentEventLoop) {
+        block();
+    } else {
+        [_eventLoop performBlock:block];
+    }
+}
+
+- (void)_removeQueuedInvocationBecauseOfTimeout:(_SPLRemoteObjectPendingInvocation *)pendingInvocation
 {
-    if ([_queuedConnections containsObject:queuedConnection]) {
-        NSDictionary *userInfo = (@{
-                                    NSLocalizedDescriptionKey: NSLocalizedString(@"Could not reach client in given timeout", @"")
-                                    });
-        NSError *error = [NSError errorWithDomain:SPLRemoteObjectErrorDomain
-                                             code:SPLRemoteObjectConnectionFailed
-                                         userInfo:userInfo];
-        invokeCompletionHandler(queuedConnection.completionBlock, nil, error);
-        queuedConnection.completionBlock = nil;
+    if ([_queuedInvocations containsObject:pendingInvocation]) {
+        [self _failPendingInvocation:pendingInvocation withErrorCode:SPLRemoteObjectConnectionFailed description:NSLocalizedString(@"Could not reach client in given timeout", @"")];
 
         [[NSNotificationCenter defaultCenter] postNotificationName:SPLRemoteObjectNetworkOperationDidEndNotification object:nil];
-        [_queuedConnections removeObject:queuedConnection];
+        [_queuedInvocations removeObject:pendingInvocation];
+    }
+}
+
+- (void)_failPendingInvocation:(_SPLRemoteObjectPendingInvocation *)pendingInvocation withErrorCode:(SPLRemoteObjectErrorCode)errorCode description:(NSString *)description
+{
+    for (_SPLRemoteObjectPendingInvocation *batchedInvocation in pendingInvocation.batchedInvocations) {
+        [self _failPendingInvocation:batchedInvocation withErrorCode:errorCode description:description];
     }
+
+    for (_SPLRemoteObjectPendingInvocation *coalescedInvocation in [self _endCoalescingPendingInvocation:pendingInvocation]) {
+        [self _failPendingInvocation:coalescedInvocation withErrorCode:errorCode description:description];
+    }
+
+    if (!pendingInvocation.completionBlock) {
+        return;
+    }
+
+    NSDictionary *userInfo = @{
+                               NSLocalizedDescriptionKey: description
+                               };
+    NSError *error = [NSError errorWithDomain:SPLRemoteObjectErrorDomain
+                                         code:errorCode
+                                     userInfo:userInfo];
+
+    invokeCompletionHandler(pendingInvocation.completionBlock, pendingInvocation.method, pendingInvocation.resultClass, pendingInvocation.completionQueue, nil, error);
+    pendingInvocation.completionBlock = nil;
 }
 
-- (void)_forwardInvocation:(NSInvocation *)anInvocation shouldRetryIfConnectionFails:(BOOL)retry
+/**
+ @return    Invocations which joined `pendingInvocation`, identical invocations sent from now on start a new request.
+ */
+- (NSArray *)_endCoalescingPendingInvocation:(_SPLRemoteObjectPendingInvocation *)pendingInvocation
 {
-    [anInvocation retainArguments];
+    if (!pendingInvocation.coalescingKey) {
+        return nil;
+    }
 
-    NSMethodSignature *methodSignature = anInvocation.methodSignature;
-    NSUInteger numberOfArguments = methodSignature.numberOfArguments;
+    if (_coalescingInvocations[pendingInvocation.coalescingKey] == pendingInvocation) {
+        [_coalescingInvocations removeObjectForKey:pendingInvocation.coalescingKey];
+    }
 
-    NSString *selectorName = NSStringFromSelector(anInvocation.selector);
+    NSArray *coalescedInvocations = pendingInvocation.coalescedInvocations;
+    pendingInvocation.coalescingKey = nil;
+    pendingInvocation.coalescedInvocations = nil;
 
-    // validate block argument
-    {
-        __unsafe_unretained id completionBlock = nil;
-        [anInvocation getArgument:&completionBlock atIndex:methodSignature.numberOfArguments - 1];
+    return coalescedInvocations;
+}
 
-        if (!completionBlock) {
-            NSLog(@"the completion block argument is mandatory");
-            [self doesNotRecognizeSelector:anInvocation.selector];
-        }
+- (dispatch_queue_t)_currentCompletionQueue
+{
+    id scopedCompletionQueue = [NSThread currentThread].threadDictionary[SPLRemoteObjectCompletionQueueThreadKey];
+    return scopedCompletionQueue ? (scopedCompletionQueue == [NSNull null] ? nil : scopedCompletionQueue) : self.completionQueue;
+}
 
-        if (!signatureMatches([methodSignature getArgumentTypeAtIndex:methodSignature.numberOfArguments - 1], @encode(dispatch_block_t))) {
-            NSLog(@"the last argument must a completion block");
-            [self doesNotRecognizeSelector:anInvocation.selector];
-        }
+- (void)_invokeRemoteMethod:(_SPLRemoteObjectMethod *)method message:(NSArray *)message completionBlock:(id)completionBlock
+{
+    dispatch_queue_t completionQueue = [self _currentCompletionQueue];
+
+    // return type, argument types and the completion block argument are validated once per method
+    if (method.unsupportedReason) {
+        NSLog(@"%@", method.unsupportedReason);
+        [self doesNotRecognizeSelector:method.selector];
+    }
+
+    BOOL isOneway = method.completionHandlerKind == _SPLRemoteObjectCompletionHandlerKindOneway;
+    if (!completionBlock && !isOneway) {
+        NSLog(@"the completion block argument is mandatory");
+        [self doesNotRecognizeSelector:method.selector];
+    }
+
+    // validate block argument, cached per method and block signature
+    Class resultClass = Nil;
+    NSString *failureReason = nil;
 
-        SLBlockDescription *blockDescription = [[SLBlockDescription alloc] initWithBlock:completionBlock];
-        NSMethodSignature *blockSignature = blockDescription.blockSignature;
+    if (!isOneway && ![method validateCompletionBlock:completionBlock resultClass:&resultClass failureReason:&failureReason]) {
+        NSLog(@"%@", failureReason);
+        [self doesNotRecognizeSelector:method.selector];
+    }
 
-        // block return type must be void
-        if (!signatureMatches(blockSignature.methodReturnType, @encode(void))) {
-            NSLog(@"completion handler can only have void return type");
-            [self doesNotRecognizeSelector:anInvocation.selector];
+    // messages of stubs, generated code and forwarded invocations are checked alike, the first element is the method identifier
+    for (NSUInteger i = 1; i < message.count; i++) {
+        if (![message[i] conformsToProtocol:@protocol(NSSecureCoding)]) {
+            NSLog(@"all objects must conform to NSSecureCoding, %@ does not", [message[i] class]);
+            [self doesNotRecognizeSelector:method.selector];
         }
+    }
 
-        if (blockSignature.numberOfArguments == 3) {
-            if (![selectorName hasSuffix:@"WithResultsCompletionHandler:"] && ![selectorName hasSuffix:@"withResultsCompletionHandler:"]) {
-                NSLog(@"method must end in (w|W)ithResultsCompletionHandler:");
-                [self doesNotRecognizeSelector:anInvocation.selector];
-            }
+    _SPLRemoteObjectPendingInvocation *pendingInvocation = [[_SPLRemoteObjectPendingInvocation alloc] init];
+    pendingInvocation.message = message;
+    pendingInvocation.method = method;
+    pendingInvocation.resultClass = resultClass;
+    pendingInvocation.completionBlock = completionBlock;
+    pendingInvocation.completionQueue = completionQueue;
+
+    SPLRemoteObjectCancellationToken *cancellationToken = [NSThread currentThread].threadDictionary[SPLRemoteObjectCancellableThreadKey];
+    if (cancellationToken) {
+        __weak typeof(self) weakSelf = self;
+        __weak _SPLRemoteObjectPendingInvocation *weakPendingInvocation = pendingInvocation;
+
+        [cancellationToken addCancellationHandler:^{
+            __strong typeof(weakSelf) strongSelf = weakSelf;
+            __strong _SPLRemoteObjectPendingInvocation *strongPendingInvocation = weakPendingInvocation;
+
+            [strongSelf _performBlockOnEventLoop:^{
+                [strongSelf _cancelPendingInvocation:strongPendingInvocation withErrorCode:SPLRemoteObjectConnectionCancelled description:NSLocalizedString(@"Invocation has been cancelled", @"")];
+            }];
+        }];
+    }
+
+    NSDate *deadline = [NSThread currentThread].threadDictionary[SPLRemoteObjectDeadlineThreadKey];
+    if (deadline) {
+        pendingInvocation.deadline = deadline;
+        [self _scheduleDeadlineForPendingInvocation:pendingInvocation];
+    }
+
+    // streams can not share a response with other invocations and are never batched
+    NSMutableArray *batchedInvocations = [NSThread currentThread].threadDictionary[SPLRemoteObjectBatchThreadKey][[NSValue valueWithNonretainedObject:self]];
+    if (batchedInvocations && method.completionHandlerKind != _SPLRemoteObjectCompletionHandlerKindStreamingResults) {
+        [batchedInvocations addObject:pendingInvocation];
+        return;
+    }
 
-            if (!signatureMatches([blockSignature getArgumentTypeAtIndex:1], @encode(id))) {
-                NSLog(@"first completion handler argument must be id typed");
-                [self doesNotRecognizeSelector:anInvocation.selector];
+    // invocations which can fail on their own never share a request
+    BOOL completesOnce = method.completionHandlerKind == _SPLRemoteObjectCompletionHandlerKindError || method.completionHandlerKind == _SPLRemoteObjectCompletionHandlerKindResults;
+    pendingInvocation.canBeCoalesced = self.coalescesIdenticalInvocations && completesOnce && !cancellationToken && !deadline;
+
+    [self _enqueuePendingInvocation:pendingInvocation shouldRetryIfConnectionFails:YES];
+}
+
+- (void)_enqueuePendingInvocation:(_SPLRemoteObjectPendingInvocation *)pendingInvocation shouldRetryIfConnectionFails:(BOOL)retry
+{
+    dispatch_async(dispatch_get_global_queue(DISPATCH_QUEUE_PRIORITY_BACKGROUND, 0), ^{
+        NSMutableArray *attachments = [NSMutableArray array];
+        NSData *dataPackage = [_SPLRemoteObjectBinaryCodec dataWithRootObject:pendingInvocation.message attachments:attachments];
+
+        // retried invocations still own their coalescing key
+        NSData *coalescingKey = pendingInvocation.canBeCoalesced && retry ? remoteObject_coalescingKey(dataPackage, attachments) : nil;
+
+        [_eventLoop performBlock:^{
+            if (pendingInvocation.cancelled) {
+                return;
             }
 
-            NSString *className = [NSString stringWithFormat:@"%s", [blockSignature getArgumentTypeAtIndex:1]];
-            className = [className substringWithRange:NSMakeRange(2, className.length - 3)];
+            if (coalescingKey) {
+                _SPLRemoteObjectPendingInvocation *coalescingInvocation = _coalescingInvocations[coalescingKey];
+                if (coalescingInvocation) {
+                    [coalescingInvocation.coalescedInvocations addObject:pendingInvocation];
+                    return;
+                }
 
-            if (![NSClassFromString(className) conformsToProtocol:@protocol(NSSecureCoding)]) {
-                NSLog(@"first completion handler argument must conform to NSSecureCoding");
-                [self doesNotRecognizeSelector:anInvocation.selector];
+                pendingInvocation.coalescingKey = coalescingKey;
+                pendingInvocation.coalescedInvocations = [NSMutableArray array];
+                _coalescingInvocations[coalescingKey] = pendingInvocation;
             }
 
-            NSString *errorClass = [NSString stringWithFormat:@"%s", [blockSignature getArgumentTypeAtIndex:2]];
-            if (![errorClass isEqual:@"@\"NSError\""]) {
-                NSLog(@"second completion handler argument must be an NSError");
-                [self doesNotRecognizeSelector:anInvocation.selector];
+            if (pendingInvocation.method.completionHandlerKind == _SPLRemoteObjectCompletionHandlerKindStreamingResults) {
+                pendingInvocation.streamQueue = dispatch_queue_create("de.sparrow-labs.SPLRemoteObject.stream", DISPATCH_QUEUE_SERIAL);
+                dispatch_set_target_queue(pendingInvocation.streamQueue, dispatch_get_global_queue(DISPATCH_QUEUE_PRIORITY_BACKGROUND, 0));
             }
-        } else if (blockSignature.numberOfArguments == 2) {
-            if (![selectorName hasSuffix:@"WithCompletionHandler:"] && ![selectorName hasSuffix:@"withCompletionHandler:"]) {
-                NSLog(@"method must end in (w|W)ithCompletionHandler:");
-                [self doesNotRecognizeSelector:anInvocation.selector];
+            pendingInvocation.dataPackage = dataPackage;
+            pendingInvocation.attachments = attachments;
+
+            if (_hostName == nil) {
+                // queue data package to laster save
+                pendingInvocation.shouldRetryIfConnectionFails = YES;
+
+                if (_timeoutInterval > 0.0) {
+                    __weak typeof(self) weakSelf = self;
+                    __weak _SPLRemoteObjectPendingInvocation *weakPendingInvocation = pendingInvocation;
+
+                    [[NSNotificationCenter defaultCenter] postNotificationName:SPLRemoteObjectNetworkOperationDidStartNotification object:nil];
+                    [_eventLoop performBlock:^{
+                        __strong typeof(weakSelf) strongSelf = weakSelf;
+                        __strong _SPLRemoteObjectPendingInvocation *strongPendingInvocation = weakPendingInvocation;
+                        [strongSelf _removeQueuedInvocationBecauseOfTimeout:strongPendingInvocation];
+                    } afterDelay:_timeoutInterval];
+                }
+
+                [_queuedInvocations addObject:pendingInvocation];
+            } else {
+                pendingInvocation.shouldRetryIfConnectionFails = retry;
+                [self _sendPendingInvocation:pendingInvocation];
             }
+        }];
+    });
+}
 
-            NSString *errorClass = [NSString stringWithFormat:@"%s", [blockSignature getArgumentTypeAtIndex:1]];
-            if (![errorClass isEqual:@"@\"NSError\""]) {
-                NSLog(@"completion handler argument must be an NSError");
-                [self doesNotRecognizeSelector:anInvocation.selector];
+- (void)_installStubImplementations
+{
+    // one dynamic subclass per protocol, stubs encode their arguments straight into a message and skip message forwarding
+    NSString *classSuffix = [NSString stringWithFormat:@"SPLRemoteObjectStubs_%s", protocol_getName(_protocol)];
+    _SPLRemoteObjectMethodTable *methodTable = _methodTable;
+
+    object_ensureDynamicSubclass(self, classSuffix, ^(id<SLDynamicSubclassConstructor> constructor) {
+        for (_SPLRemoteObjectMethod *method in methodTable.methods) {
+            id implementation = method.stubImplementation ?: (method.unsupportedReason || !method.hasOnlyObjectArguments ? nil : remoteObject_stubImplementation(method));
+
+            if (implementation) {
+                [constructor implementInstanceMethodNamed:method.selector types:method.typeEncoding implementation:implementation];
             }
+        }
+    });
+}
+
+- (void)_retryPendingInvocation:(_SPLRemoteObjectPendingInvocation *)pendingInvocation
+{
+    if (pendingInvocation.didReceiveStreamItem) {
+        return [self _failPendingInvocation:pendingInvocation withErrorCode:SPLRemoteObjectConnectionEnded description:NSLocalizedString(@"Connection to remote host ended during the stream", @"")];
+    }
+
+    // the same invocation is sent again, cancellation tokens and deadlines only hold a weak reference to it
+    pendingInvocation.identifier = 0;
+    pendingInvocation.connection = nil;
+    pendingInvocation.wasSentOverReusedConnection = NO;
+    pendingInvocation.streamQueue = nil;
+    pendingInvocation.timeoutGeneration++;
+
+    [self _enqueuePendingInvocation:pendingInvocation shouldRetryIfConnectionFails:NO];
+}
+
+- (void)_sendPendingInvocation:(_SPLRemoteObjectPendingInvocation *)pendingInvocation
+{
+    if (pendingInvocation.cancelled) {
+        return;
+    }
+
+    _SPLRemoteObjectHostConnection *connection = [_connectionPool connectionToHost:_hostName port:_port];
+    pendingInvocation.wasSentOverReusedConnection = connection != nil;
+
+    if (!connection) {
+        connection = [[_SPLRemoteObjectHostConnection alloc] initWithHostAddress:_hostName port:_port];
+        connection.eventLoop = _eventLoop;
+        connection.connectTimeoutInterval = _connectTimeoutInterval;
+        connection.delegate = self;
+        [connection connect];
+        [self _sendHandshakeOverConnection:connection];
+
+        if (![_connectionPool addConnection:connection]) {
+            [_activeConnection addObject:connection];
+        }
+    }
+
+    // incompatible methods in a batch are answered by the remote host
+    if (pendingInvocation.method && [connection.incompatibleMethodIdentifiers containsIndex:pendingInvocation.method.identifier]) {
+        [self _failPendingInvocation:pendingInvocation withErrorCode:SPLRemoteObjectConnectionIncompatibleProtocol description:NSLocalizedString(@"Remote host does not implement this method", @"")];
+        [self _connectionDidBecomeIdle:connection];
+        return;
+    }
+
+    uint32_t identifier = ++_lastInvocationIdentifier;
+    pendingInvocation.identifier = identifier;
+    pendingInvocation.connection = connection;
+    pendingInvocation.requestEndOffset = UINT64_MAX;
+
+    NSData *dataPackage = pendingInvocation.dataPackage;
+    NSArray *attachments = pendingInvocation.attachments;
+    pendingInvocation.dataPackage = nil;
+    pendingInvocation.attachments = nil;
+
+    // one-way invocations are released as soon as they are queued, the remote host never answers them
+    BOOL isOneway = pendingInvocation.method.completionHandlerKind == _SPLRemoteObjectCompletionHandlerKindOneway;
+    _SPLRemoteObjectFrameType type = pendingInvocation.batchedInvocations ? _SPLRemoteObjectFrameTypeBatch : _SPLRemoteObjectFrameTypeInvocation;
+
+    if (!isOneway) {
+        connection.pendingInvocations[@(identifier)] = pendingInvocation;
+        [self _scheduleTimeoutForPendingInvocation:pendingInvocation onConnection:connection];
+    }
+
+    [self _encodeDataPackage:dataPackage attachments:attachments forConnection:connection completionHandler:^(NSData *encodedDataPackage, NSArray *encodedAttachments, uint8_t flags) {
+        // cancelled, timed out or failed while it was compressed and encrypted
+        if (!isOneway && connection.pendingInvocations[@(identifier)] != pendingInvocation) {
+            return;
+        }
+
+        // the budget is taken when the invocation leaves, time spent queued or connecting is already used up
+        NSData *prefix = nil;
+        if (pendingInvocation.deadline) {
+            prefix = [_SPLRemoteObjectConnection deadlinePrefixWithBudget:pendingInvocation.deadline.timeIntervalSinceNow flags:&flags];
+        }
+
+        [connection sendDataPackage:encodedDataPackage prefix:prefix attachments:encodedAttachments identifier:identifier type:type flags:flags];
+
+        if (isOneway) {
+            [self _connectionDidBecomeIdle:connection];
         } else {
-            NSLog(@"completion handler not supported");
-            [self doesNotRecognizeSelector:anInvocation.selector];
+            pendingInvocation.requestEndOffset = connection.numberOfQueuedBytes;
         }
+    }];
+}
+
+/**
+ @abstract  Compresses with the codec negotiated on `connection`, then encrypts. Runs off the event loop, `completionHandler` is called on the event loop.
+ */
+- (void)_encodeDataPackage:(NSData *)dataPackage attachments:(NSArray *)attachments forConnection:(_SPLRemoteObjectHostConnection *)connection completionHandler:(void(^)(NSData *dataPackage, NSArray *attachments, uint8_t flags))completionHandler
+{
+    _SPLRemoteObjectCompressionCodec codec = connection.compressionCodec;
+
+    dispatch_async(dispatch_get_global_queue(DISPATCH_QUEUE_PRIORITY_BACKGROUND, 0), ^{
+        // compress before encrypting, encrypted data does not compress
+        uint8_t flags = 0;
+        NSData *encodedDataPackage = [_SPLRemoteObjectCompression dataByCompressingData:dataPackage codec:codec flags:&flags];
+        NSArray *encodedAttachments = attachments;
+
+        if (self.encryptionPolicy) {
+            encodedDataPackage = [self.encryptionPolicy dataByEncryptingData:encodedDataPackage];
+            encodedAttachments = remoteObject_transformAttachments(attachments, ^NSData *(NSData *attachment) {
+                return [self.encryptionPolicy dataByEncryptingData:attachment];
+            });
+        }
+
+        [_eventLoop performBlock:^{
+            completionHandler(encodedDataPackage, encodedAttachments, flags);
+        }];
+    });
+}
+
+- (void)_cancelPendingInvocation:(_SPLRemoteObjectPendingInvocation *)pendingInvocation withErrorCode:(SPLRemoteObjectErrorCode)errorCode description:(NSString *)description
+{
+    if (!pendingInvocation || pendingInvocation.cancelled) {
+        return;
     }
 
-    // return type must be zero
-    if (!signatureMatches(methodSignature.methodReturnType, @encode(void))) {
-        NSLog(@"can only call methods with a void return type");
-        [self doesNotRecognizeSelector:anInvocation.selector];
+    pendingInvocation.cancelled = YES;
+    [self _failPendingInvocation:pendingInvocation withErrorCode:errorCode description:description];
+
+    // a batch shares one request, it is only cancelled on the remote host once all of its invocations are cancelled
+    _SPLRemoteObjectPendingInvocation *batch = pendingInvocation.batch;
+    if (batch) {
+        for (_SPLRemoteObjectPendingInvocation *batchedInvocation in batch.batchedInvocations) {
+            if (!batchedInvocation.cancelled) {
+                return;
+            }
+        }
+
+        return [self _cancelPendingInvocation:batch withErrorCode:errorCode description:description];
+    }
+
+    if ([_queuedInvocations containsObject:pendingInvocation]) {
+        [[NSNotificationCenter defaultCenter] postNotificationName:SPLRemoteObjectNetworkOperationDidEndNotification object:nil];
+        [_queuedInvocations removeObject:pendingInvocation];
+        return;
+    }
+
+    _SPLRemoteObjectHostConnection *connection = pendingInvocation.connection;
+    NSNumber *identifier = @(pendingInvocation.identifier);
+    if (connection.pendingInvocations[identifier] != pendingInvocation) {
+        return;
+    }
+
+    [connection.pendingInvocations removeObjectForKey:identifier];
+    [connection sendDataPackage:[NSData data] identifier:pendingInvocation.identifier type:_SPLRemoteObjectFrameTypeCancel flags:0];
+
+    if (connection.pendingInvocations.count == 0) {
+        [self _connectionDidBecomeIdle:connection];
     }
+}
+
+- (void)_scheduleDeadlineForPendingInvocation:(_SPLRemoteObjectPendingInvocation *)pendingInvocation
+{
+    __weak typeof(self) weakSelf = self;
+    __weak _SPLRemoteObjectPendingInvocation *weakPendingInvocation = pendingInvocation;
+    [_eventLoop performBlock:^{
+        __strong typeof(weakSelf) strongSelf = weakSelf;
+        __strong _SPLRemoteObjectPendingInvocation *strongPendingInvocation = weakPendingInvocation;
+
+        [strongSelf _cancelPendingInvocation:strongPendingInvocation withErrorCode:SPLRemoteObjectConnectionTimedOut description:NSLocalizedString(@"Deadline of invocation has passed", @"")];
+    } afterDelay:MAX(pendingInvocation.deadline.timeIntervalSinceNow, 0.0)];
+}
+
+- (void)_scheduleTimeoutForPendingInvocation:(_SPLRemoteObjectPendingInvocation *)pendingInvocation onConnection:(_SPLRemoteObjectHostConnection *)connection
+{
+    NSUInteger timeoutGeneration = ++pendingInvocation.timeoutGeneration;
+    NSTimeInterval timeoutInterval = pendingInvocation.deadline ? MAX(pendingInvocation.deadline.timeIntervalSinceNow, 0.0) : SPLRemoteObjectResponseTimeoutInterval;
+
+    __weak typeof(self) weakSelf = self;
+    __weak _SPLRemoteObjectHostConnection *weakConnection = connection;
+    __weak _SPLRemoteObjectPendingInvocation *weakPendingInvocation = pendingInvocation;
+    [_eventLoop performBlock:^{
+        __strong typeof(weakSelf) strongSelf = weakSelf;
+        __strong _SPLRemoteObjectHostConnection *strongConnection = weakConnection;
+        __strong _SPLRemoteObjectPendingInvocation *strongPendingInvocation = weakPendingInvocation;
+
+        if (strongPendingInvocation.timeoutGeneration == timeoutGeneration) {
+            [strongSelf _pendingInvocation:strongPendingInvocation didTimeOutOnConnection:strongConnection];
+        }
+    } afterDelay:timeoutInterval];
+}
+
+- (void)_connection:(_SPLRemoteObjectHostConnection *)connection didReceiveStreamItem:(NSData *)dataPackage attachments:(NSArray *)attachments header:(_SPLRemoteObjectFrameHeader)header
+{
+    _SPLRemoteObjectPendingInvocation *pendingInvocation = connection.pendingInvocations[@(header.identifier)];
+    id streamingResultsHandler = pendingInvocation.completionBlock;
+
+    if (!pendingInvocation.streamQueue || !streamingResultsHandler) {
+        return;
+    }
+
+    [self _scheduleTimeoutForPendingInvocation:pendingInvocation onConnection:connection];
+    pendingInvocation.didReceiveStreamItem = YES;
 
-    // validate arguments
-    for (NSUInteger i = 2; i < numberOfArguments - 2; i++) {
-        if (i > 1) {
-            if (!signatureMatches([methodSignature getArgumentTypeAtIndex:i], @encode(id))) {
-                NSLog(@"all arguments must be an id typed subclass");
-                [self doesNotRecognizeSelector:anInvocation.selector];
+    _SPLRemoteObjectMethod *method = pendingInvocation.method;
+    Class resultClass = pendingInvocation.resultClass;
+    dispatch_queue_t completionQueue = pendingInvocation.completionQueue;
+    uint8_t flags = header.flags;
+
+    dispatch_async(pendingInvocation.streamQueue, ^{
+        if (pendingInvocation.streamFailed) {
+            return;
+        }
+
+        id item = nil;
+
+        @try {
+            NSData *thisDataPackage = dataPackage;
+            NSArray *theseAttachments = attachments;
+
+            if (self.encryptionPolicy) {
+                thisDataPackage = [self.encryptionPolicy dataByDescryptingData:thisDataPackage];
+                theseAttachments = remoteObject_transformAttachments(attachments, ^NSData *(NSData *attachment) {
+                    return [self.encryptionPolicy dataByDescryptingData:attachment];
+                });
             }
+            thisDataPackage = [_SPLRemoteObjectCompression dataByDecompressingData:thisDataPackage flags:flags];
+
+            item = [_SPLRemoteObjectBinaryCodec rootObjectWithData:thisDataPackage attachments:theseAttachments allowedClasses:_methodTable.allowedClasses];
+        } @catch (NSException *exception) {
+            NSLog(@"[%@] invalid stream item: %@", NSStringFromSelector(_cmd), exception.reason);
+
+            // ended right here so that no later item is delivered after the error
+            pendingInvocation.streamFailed = YES;
+            invokeCompletionHandler(streamingResultsHandler, method, resultClass, completionQueue, nil, [NSError errorWithDomain:SPLRemoteObjectErrorDomain code:SPLRemoteObjectConnectionIncompatibleProtocol userInfo:NULL]);
+
+            [_eventLoop performBlock:^{
+                [self _pendingInvocation:pendingInvocation didFailStreamOnConnection:connection];
+            }];
+            return;
+        }
+
+        if ([item isKindOfClass:[_SPLNil class]]) {
+            item = nil;
         }
+
+        invokeStreamingResultsHandler(streamingResultsHandler, resultClass, completionQueue, item);
+    });
+}
+
+- (void)_pendingInvocation:(_SPLRemoteObjectPendingInvocation *)pendingInvocation didFailStreamOnConnection:(_SPLRemoteObjectHostConnection *)connection
+{
+    pendingInvocation.completionBlock = nil;
+
+    NSNumber *identifier = @(pendingInvocation.identifier);
+    if (connection.pendingInvocations[identifier] != pendingInvocation) {
+        return;
     }
 
-    // Now build remote invocation
-    NSInvocation *remoteInvocation = [NSInvocation invocationWithMethodSignature:methodSignature];
-    remoteInvocation.selector = anInvocation.selector;
+    // the remote host stops streaming items nobody decodes anymore
+    [connection.pendingInvocations removeObjectForKey:identifier];
+    [connection sendDataPackage:[NSData data] identifier:pendingInvocation.identifier type:_SPLRemoteObjectFrameTypeCancel flags:0];
 
-    for (NSUInteger i = 2; i < numberOfArguments - 1; i++) {
-        __unsafe_unretained id object = nil;
-        [anInvocation getArgument:&object atIndex:i];
-        [remoteInvocation setArgument:&object atIndex:i];
+    if (connection.pendingInvocations.count == 0) {
+        [self _connectionDidBecomeIdle:connection];
     }
-    [remoteInvocation retainArguments];
+}
 
-    NSDictionary *dictionary = [remoteInvocation remoteObjectDictionaryRepresentationForProtocol:_protocol];
+- (void)_pendingBatch:(_SPLRemoteObjectPendingInvocation *)pendingBatch didReceiveDataPackage:(NSData *)dataPackage attachments:(NSArray *)attachments flags:(uint8_t)flags
+{
+    NSArray *batchedInvocations = pendingBatch.batchedInvocations;
+    NSMutableArray *completionBlocks = [NSMutableArray arrayWithCapacity:batchedInvocations.count];
+
+    for (_SPLRemoteObjectPendingInvocation *batchedInvocation in batchedInvocations) {
+        [completionBlocks addObject:batchedInvocation.completionBlock ?: [NSNull null]];
+        batchedInvocation.completionBlock = nil;
+    }
 
+    // the response is one array with a result for every invocation of the batch, decoded once and fanned out
     dispatch_async(dispatch_get_global_queue(DISPATCH_QUEUE_PRIORITY_BACKGROUND, 0), ^{
-        __block NSData *dataPackage = [NSKeyedArchiver archivedDataWithRootObject:dictionary];
+        NSArray *responses = nil;
+
+        @try {
+            NSData *thisDataPackage = dataPackage;
+            NSArray *theseAttachments = attachments;
 
-        dispatch_async(dispatch_get_main_queue(), ^{
             if (self.encryptionPolicy) {
-                dataPackage = [self.encryptionPolicy dataByEncryptingData:dataPackage];
+                thisDataPackage = [self.encryptionPolicy dataByDescryptingData:thisDataPackage];
+                theseAttachments = remoteObject_transformAttachments(attachments, ^NSData *(NSData *attachment) {
+                    return [self.encryptionPolicy dataByDescryptingData:attachment];
+                });
             }
+            thisDataPackage = [_SPLRemoteObjectCompression dataByDecompressingData:thisDataPackage flags:flags];
+            responses = [_SPLRemoteObjectBinaryCodec rootObjectWithData:thisDataPackage attachments:theseAttachments allowedClasses:_methodTable.allowedClasses];
+        } @catch (NSException *exception) {
+            NSLog(@"[%@] invalid batch response: %@", NSStringFromSelector(_cmd), exception.reason);
+        }
 
-            if (self.netService.hostName == nil) {
-                // queue data package to laster save
-                __unsafe_unretained id completionBlock = nil;
-                [anInvocation getArgument:&completionBlock atIndex:anInvocation.methodSignature.numberOfArguments - 1];
-
-                _SPLRemoteObjectQueuedConnection *queuedConnection = [[_SPLRemoteObjectQueuedConnection alloc] init];
-                queuedConnection.completionBlock = completionBlock;
-                queuedConnection.dataPackage = dataPackage;
-                queuedConnection.shouldRetryIfConnectionFails = YES;
-                objc_setAssociatedObject(queuedConnection, &SPLRemoteObjectInvocationKey, anInvocation, OBJC_ASSOCIATION_RETAIN_NONATOMIC);
+        BOOL isValidResponse = [responses isKindOfClass:[NSArray class]] && responses.count == batchedInvocations.count;
 
-                if (_timeoutInterval > 0.0) {
-                    __weak typeof(self) weakSelf = self;
-                    __weak _SPLRemoteObjectQueuedConnection *weakConnection = queuedConnection;
-                    dispatch_time_t popTime = dispatch_time(DISPATCH_TIME_NOW, _timeoutInterval * NSEC_PER_SEC);
+        [batchedInvocations enumerateObjectsUsingBlock:^(_SPLRemoteObjectPendingInvocation *batchedInvocation, NSUInteger index, BOOL *stop) {
+            id completionBlock = completionBlocks[index];
+            if (completionBlock == [NSNull null]) {
+                return;
+            }
 
-                    [[NSNotificationCenter defaultCenter] postNotificationName:SPLRemoteObjectNetworkOperationDidStartNotification object:nil];
-                    dispatch_after(popTime, dispatch_get_main_queue(), ^{
-                        __strong typeof(weakSelf) strongSelf = weakSelf;
-                        __strong _SPLRemoteObjectQueuedConnection *strongConnection = weakConnection;
-                        [strongSelf _removeQueuedConnectionBecauseOfTimeout:strongConnection];
-                    });
-                }
+            id object = isValidResponse ? responses[index] : [[_SPLIncompatibleResponse alloc] init];
+            if ([object isKindOfClass:[_SPLNil class]]) {
+                object = nil;
+            }
 
-                [_queuedConnections addObject:queuedConnection];
+            if ([object isKindOfClass:[_SPLIncompatibleResponse class]]) {
+                invokeCompletionHandler(completionBlock, batchedInvocation.method, batchedInvocation.resultClass, batchedInvocation.completionQueue, nil, [NSError errorWithDomain:SPLRemoteObjectErrorDomain code:SPLRemoteObjectConnectionIncompatibleProtocol userInfo:NULL]);
             } else {
-                __unsafe_unretained id completionBlock = nil;
-                [anInvocation getArgument:&completionBlock atIndex:anInvocation.methodSignature.numberOfArguments - 1];
+                invokeCompletionHandler(completionBlock, batchedInvocation.method, batchedInvocation.resultClass, batchedInvocation.completionQueue, object, nil);
+            }
+        }];
+    });
+}
+
+- (void)_updateSubscriptions
+{
+    NSArray *eventNames = [[NSSet setWithArray:[_subscriptions valueForKey:NSStringFromSelector(@selector(eventName))]].allObjects sortedArrayUsingSelector:@selector(compare:)];
+
+    if (eventNames.count == 0) {
+        return [self _closeSubscriptionConnection];
+    }
+
+    // sent once the remote host has been resolved
+    if (_hostName == nil) {
+        return;
+    }
+
+    if (!_subscriptionConnection) {
+        _subscriptionConnection = [[_SPLRemoteObjectHostConnection alloc] initWithHostAddress:_hostName port:_port];
+        _subscriptionConnection.eventLoop = _eventLoop;
+        _subscriptionConnection.connectTimeoutInterval = _connectTimeoutInterval;
+        _subscriptionConnection.delegate = self;
+        [_subscriptionConnection connect];
+        [self _sendHandshakeOverConnection:_subscriptionConnection];
+
+        [_activeConnection addObject:_subscriptionConnection];
+    }
+
+    // every subscription frame replaces the previous one, so a reopened connection simply sends the current state
+    NSData *dataPackage = [_SPLRemoteObjectBinaryCodec dataWithRootObject:eventNames];
+    if (self.encryptionPolicy) {
+        dataPackage = [self.encryptionPolicy dataByEncryptingData:dataPackage];
+    }
 
-                _SPLRemoteObjectHostConnection *connection = [[_SPLRemoteObjectHostConnection alloc] initWithHostAddress:self.netService.hostName port:self.netService.port];
-                connection.completionBlock = completionBlock;
-                connection.delegate = self;
-                connection.shouldRetryIfConnectionFails = retry;
-                objc_setAssociatedObject(connection, &SPLRemoteObjectInvocationKey, anInvocation, OBJC_ASSOCIATION_RETAIN_NONATOMIC);
+    [_subscriptionConnection sendDataPackage:dataPackage identifier:0 type:_SPLRemoteObjectFrameTypeSubscription flags:0];
+}
 
-                [_activeConnection addObject:connection];
+- (void)_closeSubscriptionConnection
+{
+    if (!_subscriptionConnection) {
+        return;
+    }
 
-                [connection connect];
-                [connection sendDataPackage:dataPackage];
+    _subscriptionConnection.delegate = nil;
+    [_subscriptionConnection disconnect];
+    [_activeConnection removeObject:_subscriptionConnection];
+    _subscriptionConnection = nil;
+}
+
+- (void)_subscriptionConnectionDidEnd
+{
+    _subscriptionConnection = nil;
+
+    if (_subscriptions.count == 0) {
+        return;
+    }
+
+    __weak typeof(self) weakSelf = self;
+    [_eventLoop performBlock:^{
+        __strong typeof(weakSelf) strongSelf = weakSelf;
+        if (!strongSelf.subscriptionConnection) {
+            [strongSelf _updateSubscriptions];
+        }
+    } afterDelay:SPLRemoteObjectSubscriptionReconnectInterval];
+}
+
+- (void)_connection:(_SPLRemoteObjectHostConnection *)connection didReceiveEvent:(NSData *)dataPackage attachments:(NSArray *)attachments header:(_SPLRemoteObjectFrameHeader)header
+{
+    NSArray *subscriptions = [_subscriptions copy];
+    uint8_t flags = header.flags;
+
+    dispatch_async(dispatch_get_global_queue(DISPATCH_QUEUE_PRIORITY_BACKGROUND, 0), ^{
+        @try {
+            NSData *thisDataPackage = dataPackage;
+            NSArray *theseAttachments = attachments;
+
+            if (self.encryptionPolicy) {
+                thisDataPackage = [self.encryptionPolicy dataByDescryptingData:thisDataPackage];
+                theseAttachments = remoteObject_transformAttachments(attachments, ^NSData *(NSData *attachment) {
+                    return [self.encryptionPolicy dataByDescryptingData:attachment];
+                });
             }
-        });
+            thisDataPackage = [_SPLRemoteObjectCompression dataByDecompressingData:thisDataPackage flags:flags];
+
+            NSArray *message = [_SPLRemoteObjectBinaryCodec rootObjectWithData:thisDataPackage attachments:theseAttachments allowedClasses:_methodTable.allowedClasses];
+            if (![message isKindOfClass:[NSArray class]] || message.count != 2) {
+                return;
+            }
+
+            NSString *eventName = message[0];
+            id event = [message[1] isKindOfClass:[_SPLNil class]] ? nil : message[1];
+
+            for (_SPLRemoteObjectSubscription *subscription in subscriptions) {
+                if (![subscription.eventName isEqual:eventName]) {
+                    continue;
+                }
+
+                SPLRemoteObjectEventBlock handler = subscription.handler;
+                dispatch_queue_t completionQueue = subscription.completionQueue;
+
+                if (!completionQueue) {
+                    handler(event);
+                } else {
+                    dispatch_async(completionQueue, ^{
+                        handler(event);
+                    });
+                }
+            }
+        } @catch (NSException *exception) {
+            NSLog(@"[%@] invalid event: %@", NSStringFromSelector(_cmd), exception.reason);
+        }
     });
 }
 
+- (void)_sendHandshakeOverConnection:(_SPLRemoteObjectHostConnection *)connection
+{
+    NSDictionary *handshake = @{
+                                @"version": @(_SPLRemoteObjectHandshakeVersion),
+                                @"methods": _methodTable.handshakeRepresentation,
+                                @"compression": [_SPLRemoteObjectCompression supportedCodecNames],
+                                };
+
+    NSData *dataPackage = [_SPLRemoteObjectBinaryCodec dataWithRootObject:handshake];
+    if (self.encryptionPolicy) {
+        dataPackage = [self.encryptionPolicy dataByEncryptingData:dataPackage];
+    }
+
+    [connection sendDataPackage:dataPackage identifier:0 type:_SPLRemoteObjectFrameTypeHandshake flags:0];
+}
+
+- (void)_connection:(_SPLRemoteObjectHostConnection *)connection didReceiveHandshake:(NSData *)dataPackage
+{
+    @try {
+        if (self.encryptionPolicy) {
+            dataPackage = [self.encryptionPolicy dataByDescryptingData:dataPackage];
+        }
+
+        NSDictionary *handshake = [_SPLRemoteObjectBinaryCodec rootObjectWithData:dataPackage];
+        NSMutableIndexSet *incompatibleMethodIdentifiers = [NSMutableIndexSet indexSet];
+
+        for (NSNumber *identifier in handshake[@"incompatible_methods"]) {
+            [incompatibleMethodIdentifiers addIndex:identifier.unsignedIntegerValue];
+        }
+
+        connection.incompatibleMethodIdentifiers = incompatibleMethodIdentifiers;
+        connection.compressionCodec = [_SPLRemoteObjectCompression preferredCodecWithNames:@[ handshake[@"compression"] ?: [NSNull null] ]];
+    } @catch (NSException *exception) {
+        NSLog(@"[%@] invalid handshake: %@", NSStringFromSelector(_cmd), exception.reason);
+    }
+}
+
+- (void)_pendingInvocation:(_SPLRemoteObjectPendingInvocation *)pendingInvocation didTimeOutOnConnection:(_SPLRemoteObjectHostConnection *)connection
+{
+    NSNumber *identifier = @(pendingInvocation.identifier);
+    if (!pendingInvocation || connection.pendingInvocations[identifier] != pendingInvocation) {
+        return;
+    }
+
+    // only this invocation failed, other invocations on the same connection may still succeed
+    [connection.pendingInvocations removeObjectForKey:identifier];
+    [self _failPendingInvocation:pendingInvocation withErrorCode:SPLRemoteObjectConnectionTimedOut description:NSLocalizedString(@"Remote host did not respond in time", @"")];
+
+    if (connection.pendingInvocations.count == 0) {
+        [self _connectionDidBecomeIdle:connection];
+    }
+}
+
+- (void)_connectionDidBecomeIdle:(_SPLRemoteObjectHostConnection *)connection
+{
+    if (connection.pendingInvocations.count > 0) {
+        return;
+    }
+
+    if ([_connectionPool containsConnection:connection]) {
+        [_connectionPool connectionDidBecomeIdle:connection];
+    } else {
+        // one-way invocations may still be queued on the connection
+        NSMutableArray *activeConnection = _activeConnection;
+        [connection disconnectAfterSendingQueuedDataWithCompletionHandler:^{
+            [activeConnection removeObject:connection];
+        }];
+    }
+}
+
 - (BOOL)_invalidateDNSCache
 {
     NSString *serviceName = [NSString stringWithFormat:@"%@.%@local.", self.name, [self.type netServiceTypeWithProtocol:self.protocol]];
@@ -635,4 +1650,6 @@ static void * SPLRemoteObjectObserver = &SPLRemoteObjectObserver;
 
 @end
 
-@implementation _SPLRemoteObjectQueuedConnection @end
+@implementation _SPLRemoteObjectPendingInvocation @end
+
+@implementation _SPLRemoteObjectSubscription @end
@@ -29,6 +29,7 @@
 NS_ASSUME_NONNULL_BEGIN
 
 typedef void(^SPLRemoteObjectErrorBlock)(NSError *__nullable error);
+typedef void(^SPLRemoteObjectEventBlock)(id __nullable event);
 typedef NSData *__nonnull(^SPLRemoteObjectDataEncryptionBlock)(NSData *__nonnull rawData, NSData *__nonnull symmetricKey);
 typedef NSData *__nonnull(^SPLRemoteObjectDataDecryptionBlock)(NSData *__nonnull encryptedData, NSData *__nonnull symmetricKey);
 
@@ -60,7 +61,9 @@ extern NSString *const SPLRemoteObjectErrorDomain;
 typedef enum {
     SPLRemoteObjectConnectionFailed = 1000,
     SPLRemoteObjectConnectionTimedOut = 1001,
-    SPLRemoteObjectConnectionIncompatibleProtocol = 1002
+    SPLRemoteObjectConnectionIncompatibleProtocol = 1002,
+    SPLRemoteObjectConnectionCancelled = 1003,
+    SPLRemoteObjectConnectionEnded = 1004 // the connection ended after a stream delivered items, streams are never replayed
 } SPLRemoteObjectErrorCode;
 
 NS_ASSUME_NONNULL_END
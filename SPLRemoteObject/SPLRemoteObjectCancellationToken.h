@@ -0,0 +1,52 @@
+//
+//  SPLRemoteObjectCancellationToken.h
+//  SPLRemoteObject
+//
+//  The MIT License (MIT)
+//  Copyright (c) 2013 Oliver Letterer, Sparrow-Labs
+//
+//  Permission is hereby granted, free of charge, to any person obtaining a copy
+//  of this software and associated documentation files (the "Software"), to deal
+//  in the Software without restriction, including without limitation the rights
+//  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+//  copies of the Software, and to permit persons to whom the Software is
+//  furnished to do so, subject to the following conditions:
+//
+//  The above copyright notice and this permission notice shall be included in
+//  all copies or substantial portions of the Software.
+//
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+//  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+//  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+//  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+//  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+//  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+//  THE SOFTWARE.
+//
+
+#import <Foundation/Foundation.h>
+
+NS_ASSUME_NONNULL_BEGIN
+
+/**
+ @abstract  Cancels remote invocations. On the client, -[SPLRemoteObject performCancellable:] returns a token for all invocations sent from its block. On the proxy, targets get the token of the request they are serving from +currentToken.
+ */
+@interface SPLRemoteObjectCancellationToken : NSObject
+
+/**
+ Token of the request the target is serving, only set while a target method is called by SPLRemoteObjectProxy. Retain it to check for cancellation later.
+ */
++ (nullable instancetype)currentToken;
+
+@property (atomic, readonly, getter=isCancelled) BOOL cancelled;
+
+- (void)cancel;
+
+/**
+ @abstract  `handler` is called once on the thread which cancels this token, or immediately if it already has been cancelled.
+ */
+- (void)addCancellationHandler:(dispatch_block_t)handler;
+
+@end
+
+NS_ASSUME_NONNULL_END
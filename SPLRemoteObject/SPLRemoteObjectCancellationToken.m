@@ -0,0 +1,113 @@
+//
+//  SPLRemoteObjectCancellationToken.m
+//  SPLRemoteObject
+//
+//  The MIT License (MIT)
+//  Copyright (c) 2013 Oliver Letterer, Sparrow-Labs
+//
+//  Permission is hereby granted, free of charge, to any person obtaining a copy
+//  of this software and associated documentation files (the "Software"), to deal
+//  in the Software without restriction, including without limitation the rights
+//  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+//  copies of the Software, and to permit persons to whom the Software is
+//  furnished to do so, subject to the following conditions:
+//
+//  The above copyright notice and this permission notice shall be included in
+//  all copies or substantial portions of the Software.
+//
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+//  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+//  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+//  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+//  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+//  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+//  THE SOFTWARE.
+//
+
+#import "SPLRemoteObjectCancellationToken.h"
+
+static NSString * const SPLRemoteObjectCancellationTokenThreadKey = @"SPLRemoteObjectCancellationTokenThreadKey";
+
+
+
+@interface SPLRemoteObjectCancellationToken ()
+
+@property (atomic, assign, getter=isCancelled) BOOL cancelled;
+@property (nonatomic, readonly) NSMutableArray *cancellationHandlers;
+
+@end
+
+
+
+@implementation SPLRemoteObjectCancellationToken
+
++ (instancetype)currentToken
+{
+    return [NSThread currentThread].threadDictionary[SPLRemoteObjectCancellationTokenThreadKey];
+}
+
++ (void)performWithCurrentToken:(SPLRemoteObjectCancellationToken *)token block:(dispatch_block_t)block
+{
+    NSParameterAssert(block);
+
+    NSMutableDictionary *threadDictionary = [NSThread currentThread].threadDictionary;
+    id previousToken = threadDictionary[SPLRemoteObjectCancellationTokenThreadKey];
+
+    threadDictionary[SPLRemoteObjectCancellationTokenThreadKey] = token;
+    @try {
+        block();
+    } @finally {
+        if (previousToken) {
+            threadDictionary[SPLRemoteObjectCancellationTokenThreadKey] = previousToken;
+        } else {
+            [threadDictionary removeObjectForKey:SPLRemoteObjectCancellationTokenThreadKey];
+        }
+    }
+}
+
+#pragma mark - Initialization
+
+- (instancetype)init
+{
+    if (self = [super init]) {
+        _cancellationHandlers = [NSMutableArray array];
+    }
+    return self;
+}
+
+#pragma mark - Instance methods
+
+- (void)cancel
+{
+    NSArray *cancellationHandlers = nil;
+
+    @synchronized(self) {
+        if (self.isCancelled) {
+            return;
+        }
+
+        self.cancelled = YES;
+        cancellationHandlers = [_cancellationHandlers copy];
+        [_cancellationHandlers removeAllObjects];
+    }
+
+    for (dispatch_block_t handler in cancellationHandlers) {
+        handler();
+    }
+}
+
+- (void)addCancellationHandler:(dispatch_block_t)handler
+{
+    NSParameterAssert(handler);
+
+    @synchronized(self) {
+        if (!self.isCancelled) {
+            [_cancellationHandlers addObject:[handler copy]];
+            return;
+        }
+    }
+
+    handler();
+}
+
+@end
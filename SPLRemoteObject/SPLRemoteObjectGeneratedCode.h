@@ -0,0 +1,56 @@
+//
+//  SPLRemoteObjectGeneratedCode.h
+//  SPLRemoteObject
+//
+//  The MIT License (MIT)
+//  Copyright (c) 2013 Oliver Letterer, Sparrow-Labs
+//
+//  Permission is hereby granted, free of charge, to any person obtaining a copy
+//  of this software and associated documentation files (the "Software"), to deal
+//  in the Software without restriction, including without limitation the rights
+//  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+//  copies of the Software, and to permit persons to whom the Software is
+//  furnished to do so, subject to the following conditions:
+//
+//  The above copyright notice and this permission notice shall be included in
+//  all copies or substantial portions of the Software.
+//
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+//  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+//  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+//  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+//  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+//  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+//  THE SOFTWARE.
+//
+
+#import <Foundation/Foundation.h>
+
+@class SPLRemoteObject;
+
+NS_ASSUME_NONNULL_BEGIN
+
+/**
+ Calls the target method with the decoded `arguments` and the completion handler which sends the response, nil for one-way methods.
+ */
+typedef void(^SPLRemoteObjectSkeleton)(id target, NSArray *arguments, id __nullable completionHandler);
+
+/**
+ @abstract  Registers a typed client stub for `selector`. Remote objects of `protocol` install `stubImplementation` instead of their generic stub. Called by code generated with Scripts/generate_remote_object_stubs.rb, register before the first remote object of `protocol` is created.
+ */
+extern void SPLRemoteObjectRegisterStub(Protocol *protocol, SEL selector, id stubImplementation);
+
+/**
+ @abstract  Registers a typed server skeleton for `selector`. Proxies of `protocol` call `skeleton` instead of building an NSInvocation.
+ */
+extern void SPLRemoteObjectRegisterSkeleton(Protocol *protocol, SEL selector, SPLRemoteObjectSkeleton skeleton);
+
+/**
+ @abstract  Sends `arguments` to the remote host, used by generated client stubs. nil arguments must be passed through SPLRemoteObjectArgument().
+ */
+extern void SPLRemoteObjectInvokeRemoteMethod(SPLRemoteObject *remoteObject, SEL selector, NSArray *arguments, id __nullable completionHandler);
+
+extern id SPLRemoteObjectArgument(id __nullable argument);
+extern id __nullable SPLRemoteObjectArgumentAtIndex(NSArray *arguments, NSUInteger index);
+
+NS_ASSUME_NONNULL_END
@@ -0,0 +1,81 @@
+//
+//  SPLRemoteObjectGeneratedCode.m
+//  SPLRemoteObject
+//
+//  The MIT License (MIT)
+//  Copyright (c) 2013 Oliver Letterer, Sparrow-Labs
+//
+//  Permission is hereby granted, free of charge, to any person obtaining a copy
+//  of this software and associated documentation files (the "Software"), to deal
+//  in the Software without restriction, including without limitation the rights
+//  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+//  copies of the Software, and to permit persons to whom the Software is
+//  furnished to do so, subject to the following conditions:
+//
+//  The above copyright notice and this permission notice shall be included in
+//  all copies or substantial portions of the Software.
+//
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+//  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+//  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+//  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+//  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+//  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+//  THE SOFTWARE.
+//
+
+#import "SPLRemoteObjectGeneratedCode.h"
+#import "SPLRemoteObject.h"
+#import "_SPLRemoteObjectMethodTable.h"
+#import "_SPLNil.h"
+#import <objc/runtime.h>
+
+
+
+@interface SPLRemoteObject (SPLRemoteObjectGeneratedCode)
+
+@property (nonatomic, readonly) _SPLRemoteObjectMethodTable *methodTable;
+
+- (void)_invokeRemoteMethod:(_SPLRemoteObjectMethod *)method message:(NSArray *)message completionBlock:(nullable id)completionBlock;
+
+@end
+
+
+
+void SPLRemoteObjectRegisterStub(Protocol *protocol, SEL selector, id stubImplementation)
+{
+    _SPLRemoteObjectMethod *method = [[_SPLRemoteObjectMethodTable methodTableForProtocol:protocol] methodForSelector:selector];
+    NSCAssert(method != nil, @"protocol %s does not contain %@", protocol_getName(protocol), NSStringFromSelector(selector));
+
+    method.stubImplementation = stubImplementation;
+}
+
+void SPLRemoteObjectRegisterSkeleton(Protocol *protocol, SEL selector, SPLRemoteObjectSkeleton skeleton)
+{
+    _SPLRemoteObjectMethod *method = [[_SPLRemoteObjectMethodTable methodTableForProtocol:protocol] methodForSelector:selector];
+    NSCAssert(method != nil, @"protocol %s does not contain %@", protocol_getName(protocol), NSStringFromSelector(selector));
+
+    method.skeleton = skeleton;
+}
+
+void SPLRemoteObjectInvokeRemoteMethod(SPLRemoteObject *remoteObject, SEL selector, NSArray *arguments, id completionHandler)
+{
+    _SPLRemoteObjectMethod *method = [remoteObject.methodTable methodForSelector:selector];
+
+    NSMutableArray *message = [NSMutableArray arrayWithCapacity:arguments.count + 1];
+    [message addObject:@(method.identifier)];
+    [message addObjectsFromArray:arguments];
+
+    [remoteObject _invokeRemoteMethod:method message:message completionBlock:completionHandler];
+}
+
+id SPLRemoteObjectArgument(id argument)
+{
+    return argument ?: [[_SPLNil alloc] init];
+}
+
+id SPLRemoteObjectArgumentAtIndex(NSArray *arguments, NSUInteger index)
+{
+    id argument = arguments[index];
+    return [argument isKindOfClass:[_SPLNil class]] ? nil : argument;
+}
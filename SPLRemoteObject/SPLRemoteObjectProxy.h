@@ -29,6 +29,7 @@
 
 #import "SPLRemoteObjectBase.h"
 #import "SPLRemoteObjectEncryptionPolicy.h"
+#import "SPLRemoteObjectCancellationToken.h"
 
 NS_ASSUME_NONNULL_BEGIN
 
@@ -43,6 +44,21 @@ NS_ASSUME_NONNULL_BEGIN
 @property (nonatomic, weak) id target;
 @property (nonatomic, readonly) Protocol *protocol;
 
+/**
+ Queue on which the target is invoked. Use a concurrent queue to serve independent calls in parallel or a queue targeting your own serial queue to serialize them. Completion blocks handed to the target may be called from any thread. Defaults to the main queue.
+ */
+@property (nonatomic, strong) dispatch_queue_t targetQueue;
+
+/**
+ Requests which run at the same time, waiting requests are started earliest deadline first. A request keeps its slot until its target method returned on `targetQueue`, so a concurrent `targetQueue` whose methods block serves at most this many calls in parallel. Raise it for such targets at the cost of a weaker deadline order. Defaults to the number of active processors, at least 2.
+ */
+@property (nonatomic, assign) NSUInteger maximumNumberOfConcurrentRequests;
+
+/**
+ Incoming connections are accepted on a dedicated networking thread instead of the main run loop and spread across one networking thread per core, which also decrypts and decodes their requests and encodes their responses. The target is still invoked on `targetQueue`. Defaults to NO.
+ */
+@property (nonatomic, assign) BOOL usesDedicatedNetworkThread;
+
 @property (nullable) id<SPLRemoteObjectEncryptionPolicy> encryptionPolicy;
 
 @property (nonatomic, nullable, copy) NSDictionary *userInfo;
@@ -50,6 +66,11 @@ NS_ASSUME_NONNULL_BEGIN
 - (instancetype)init UNAVAILABLE_ATTRIBUTE;
 - (instancetype)initWithName:(NSString *)name type:(NSString *)type protocol:(Protocol *)protocol target:(id)target completionHandler:(SPLRemoteObjectErrorBlock)completionHandler;
 
+/**
+ @abstract  Sends `event` to every connected client which subscribed to `eventName`. Can be called from any thread.
+ */
+- (void)pushEvent:(nullable id<NSSecureCoding>)event named:(NSString *)eventName;
+
 @end
 
 NS_ASSUME_NONNULL_END
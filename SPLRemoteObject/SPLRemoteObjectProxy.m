@@ -36,19 +36,116 @@
 #import "_SPLNil.h"
 #import "SPLRemoteObject.h"
 #import "_SPLIncompatibleResponse.h"
+#import "_SPLRemoteObjectBinaryCodec.h"
+#import "_SPLRemoteObjectMethodTable.h"
+#import "SPLRemoteObjectCancellationToken.h"
+#import "_SPLRemoteObjectCompression.h"
+#import "SPLRemoteObjectGeneratedCode.h"
 #import <objc/runtime.h>
+#import <pthread.h>
 
 
 
 void SPLRemoteObjectProxyServerAcceptCallback(CFSocketRef socket, CFSocketCallBackType type, CFDataRef address, const void *data, void *info);
 
+/**
+ Methods with up to this many object arguments are called through a cached IMP, all others through NSInvocation.
+ */
+static NSUInteger const SPLRemoteObjectProxyMaximumNumberOfDirectArguments = 4;
+
+static NSArray *remoteObjectProxy_transformAttachments(NSArray *attachments, NSData *(^transform)(NSData *attachment))
+{
+    NSMutableArray *result = [NSMutableArray arrayWithCapacity:attachments.count];
+    for (NSData *attachment in attachments) {
+        [result addObject:transform(attachment)];
+    }
+
+    return result;
+}
+
+static void remoteObjectProxy_callImplementation(IMP implementation, id target, SEL selector, NSArray *arguments, id completionBlock)
+{
+    switch (arguments.count) {
+        case 0:
+            ((void(*)(id, SEL, id))implementation)(target, selector, completionBlock);
+            break;
+        case 1:
+            ((void(*)(id, SEL, id, id))implementation)(target, selector, SPLRemoteObjectArgumentAtIndex(arguments, 0), completionBlock);
+            break;
+        case 2:
+            ((void(*)(id, SEL, id, id, id))implementation)(target, selector, SPLRemoteObjectArgumentAtIndex(arguments, 0), SPLRemoteObjectArgumentAtIndex(arguments, 1), completionBlock);
+            break;
+        case 3:
+            ((void(*)(id, SEL, id, id, id, id))implementation)(target, selector, SPLRemoteObjectArgumentAtIndex(arguments, 0), SPLRemoteObjectArgumentAtIndex(arguments, 1), SPLRemoteObjectArgumentAtIndex(arguments, 2), completionBlock);
+            break;
+        case 4:
+            ((void(*)(id, SEL, id, id, id, id, id))implementation)(target, selector, SPLRemoteObjectArgumentAtIndex(arguments, 0), SPLRemoteObjectArgumentAtIndex(arguments, 1), SPLRemoteObjectArgumentAtIndex(arguments, 2), SPLRemoteObjectArgumentAtIndex(arguments, 3), completionBlock);
+            break;
+        default:
+            NSCAssert(NO, @"%lu arguments cannot be called directly", (unsigned long)arguments.count);
+            break;
+    }
+}
+
+static void remoteObjectProxy_callOnewayImplementation(IMP implementation, id target, SEL selector, NSArray *arguments)
+{
+    switch (arguments.count) {
+        case 0:
+            ((void(*)(id, SEL))implementation)(target, selector);
+            break;
+        case 1:
+            ((void(*)(id, SEL, id))implementation)(target, selector, SPLRemoteObjectArgumentAtIndex(arguments, 0));
+            break;
+        case 2:
+            ((void(*)(id, SEL, id, id))implementation)(target, selector, SPLRemoteObjectArgumentAtIndex(arguments, 0), SPLRemoteObjectArgumentAtIndex(arguments, 1));
+            break;
+        case 3:
+            ((void(*)(id, SEL, id, id, id))implementation)(target, selector, SPLRemoteObjectArgumentAtIndex(arguments, 0), SPLRemoteObjectArgumentAtIndex(arguments, 1), SPLRemoteObjectArgumentAtIndex(arguments, 2));
+            break;
+        case 4:
+            ((void(*)(id, SEL, id, id, id, id))implementation)(target, selector, SPLRemoteObjectArgumentAtIndex(arguments, 0), SPLRemoteObjectArgumentAtIndex(arguments, 1), SPLRemoteObjectArgumentAtIndex(arguments, 2), SPLRemoteObjectArgumentAtIndex(arguments, 3));
+            break;
+        default:
+            NSCAssert(NO, @"%lu arguments cannot be called directly", (unsigned long)arguments.count);
+            break;
+    }
+}
+
 
 
-@interface SPLRemoteObjectProxy () <NSNetServiceDelegate, _SPLRemoteObjectConnectionDelegate>
+@interface SPLRemoteObjectCancellationToken (SPLRemoteObjectProxy)
+
++ (void)performWithCurrentToken:(SPLRemoteObjectCancellationToken *)token block:(dispatch_block_t)block;
+
+@end
+
+
+
+@interface _SPLRemoteObjectScheduledRequest : NSObject
+
+@property (nonatomic, assign) NSTimeInterval deadline; // system uptime, DBL_MAX for requests without a deadline
+@property (nonatomic, copy) void(^block)(dispatch_group_t targetGroup);
+@property (nonatomic, strong) _SPLRemoteObjectEventLoop *eventLoop; // runs `block` on this networking thread, on a global queue if nil
+
+@end
+
+
+
+@interface SPLRemoteObjectProxy () <NSNetServiceDelegate, _SPLRemoteObjectConnectionDelegate> {
+    IMP *_implementations; // indexed by method identifier, valid for _implementationsClass
+    Class _implementationsClass;
+    pthread_mutex_t _implementationsLock;
+    NSMutableArray<_SPLRemoteObjectScheduledRequest *> *_scheduledRequests; // sorted by deadline
+    NSUInteger _numberOfRunningRequests; // guarded by _scheduledRequests
+    NSUInteger _maximumNumberOfConcurrentRequests; // guarded by _scheduledRequests
+}
 
 @property (nonatomic, copy, nullable) SPLRemoteObjectErrorBlock completionHandler;
 
 @property (nonatomic, assign) CFSocketRef socket; // retained
+@property (nonatomic, assign) CFRunLoopSourceRef socketRunLoopSource; // retained
+@property (nonatomic, strong) _SPLRemoteObjectEventLoop *eventLoop;
+@property (nonatomic, strong) _SPLRemoteObjectMethodTable *methodTable;
 @property (nonatomic, assign) uint16_t port;
 @property (nonatomic, strong) NSNetService *netService;
 
@@ -62,6 +159,12 @@ void SPLRemoteObjectProxyServerAcceptCallback(CFSocketRef socket, CFSocketCallBa
 @property (nonatomic, assign) UIBackgroundTaskIdentifier backgroundTaskIdentifier;
 
 - (void)_acceptConnectionFromNewNativeSocket:(CFSocketNativeHandle)nativeSocketHandle;
+- (IMP)_implementationOfMethod:(_SPLRemoteObjectMethod *)method target:(id)target;
+- (void)_scheduleRequestWithDeadline:(NSTimeInterval)deadline eventLoop:(nullable _SPLRemoteObjectEventLoop *)eventLoop block:(void(^)(dispatch_group_t targetGroup))block;
+- (void)_startScheduledRequests;
+- (nullable _SPLRemoteObjectEventLoop *)_codingEventLoopOfConnection:(_SPLRemoteObjectConnection *)connection;
+- (void)_performCodingBlock:(dispatch_block_t)block eventLoop:(nullable _SPLRemoteObjectEventLoop *)eventLoop;
+- (BOOL)_performRemoteObjectMessage:(id)message connection:(_SPLRemoteObjectNativeSocketConnection *)connection cancellationToken:(SPLRemoteObjectCancellationToken *)cancellationToken targetGroup:(dispatch_group_t)targetGroup respond:(void(^)(id response))respond streamItem:(nullable void(^)(id item))streamItem;
 
 + (NSData *)dataFromUserInfoDictionary:(NSDictionary *)dictionary;
 
@@ -110,6 +213,72 @@ void SPLRemoteObjectProxyServerAcceptCallback(CFSocketRef socket, CFSocketCallBa
     }
 }
 
+- (void)setTarget:(id)target
+{
+    pthread_mutex_lock(&_implementationsLock);
+    _target = target;
+    _implementationsClass = Nil;
+    pthread_mutex_unlock(&_implementationsLock);
+}
+
+- (NSUInteger)maximumNumberOfConcurrentRequests
+{
+    @synchronized(_scheduledRequests) {
+        return _maximumNumberOfConcurrentRequests;
+    }
+}
+
+- (void)setMaximumNumberOfConcurrentRequests:(NSUInteger)maximumNumberOfConcurrentRequests
+{
+    NSParameterAssert(maximumNumberOfConcurrentRequests > 0);
+
+    @synchronized(_scheduledRequests) {
+        _maximumNumberOfConcurrentRequests = maximumNumberOfConcurrentRequests;
+    }
+
+    [self _startScheduledRequests];
+}
+
+- (void)setTargetQueue:(dispatch_queue_t)targetQueue
+{
+    NSParameterAssert(targetQueue);
+    _targetQueue = targetQueue;
+}
+
+- (void)setSocketRunLoopSource:(CFRunLoopSourceRef)socketRunLoopSource
+{
+    if (socketRunLoopSource != _socketRunLoopSource) {
+        if (_socketRunLoopSource != NULL) {
+            CFRelease(_socketRunLoopSource), _socketRunLoopSource = NULL;
+        }
+
+        if (socketRunLoopSource) {
+            _socketRunLoopSource = (CFRunLoopSourceRef)CFRetain(socketRunLoopSource);
+        }
+    }
+}
+
+- (BOOL)usesDedicatedNetworkThread
+{
+    return _eventLoop != [_SPLRemoteObjectEventLoop mainEventLoop];
+}
+
+- (void)setUsesDedicatedNetworkThread:(BOOL)usesDedicatedNetworkThread
+{
+    _SPLRemoteObjectEventLoop *eventLoop = usesDedicatedNetworkThread ? [_SPLRemoteObjectEventLoop networkEventLoop] : [_SPLRemoteObjectEventLoop mainEventLoop];
+    if (eventLoop == _eventLoop) {
+        return;
+    }
+
+    // already accepted connections stay on their current event loop
+    if (_socketRunLoopSource != NULL) {
+        CFRunLoopRemoveSource(_eventLoop.runLoop.getCFRunLoop, _socketRunLoopSource, kCFRunLoopCommonModes);
+        CFRunLoopAddSource(eventLoop.runLoop.getCFRunLoop, _socketRunLoopSource, kCFRunLoopCommonModes);
+    }
+
+    _eventLoop = eventLoop;
+}
+
 #pragma mark - Initialization
 
 - (instancetype)initWithName:(NSString *)name type:(NSString *)type protocol:(Protocol *)protocol target:(id)target completionHandler:(SPLRemoteObjectErrorBlock)completionHandler
@@ -120,9 +289,16 @@ void SPLRemoteObjectProxyServerAcceptCallback(CFSocketRef socket, CFSocketCallBa
 
         _target = target;
         _protocol = protocol;
+        _methodTable = [_SPLRemoteObjectMethodTable methodTableForProtocol:protocol];
+        _implementations = calloc(_methodTable.methods.count, sizeof(IMP));
+        pthread_mutex_init(&_implementationsLock, NULL);
 
         _completionHandler = [completionHandler copy];
         _openConnections = [NSMutableArray array];
+        _scheduledRequests = [NSMutableArray array];
+        _maximumNumberOfConcurrentRequests = MAX([NSProcessInfo processInfo].activeProcessorCount, 2);
+        _eventLoop = [_SPLRemoteObjectEventLoop mainEventLoop];
+        _targetQueue = dispatch_get_main_queue();
 
         NSAssert([_target conformsToProtocol:protocol], @"%@ does not conform to protocol %s", target, protocol_getName(protocol));
 
@@ -141,6 +317,9 @@ void SPLRemoteObjectProxyServerAcceptCallback(CFSocketRef socket, CFSocketCallBa
     [[NSNotificationCenter defaultCenter] removeObserver:self];
 
     [self stopServer];
+
+    free(_implementations);
+    pthread_mutex_destroy(&_implementationsLock);
 }
 
 #pragma mark - NSNotificationCenter
@@ -194,6 +373,58 @@ void SPLRemoteObjectProxyServerAcceptCallback(CFSocketRef socket, CFSocketCallBa
     [self _unpublishService];
 }
 
+- (void)pushEvent:(id<NSSecureCoding>)event named:(NSString *)eventName
+{
+    NSParameterAssert(eventName);
+
+    [_eventLoop performBlock:^{
+        NSMutableArray *subscribers = [NSMutableArray array];
+        for (_SPLRemoteObjectNativeSocketConnection *connection in _openConnections) {
+            if ([connection.subscribedEventNames containsObject:eventName]) {
+                [subscribers addObject:connection];
+            }
+        }
+
+        if (subscribers.count == 0) {
+            return;
+        }
+
+        // the event is encoded once and compressed and encrypted once per codec, not once per subscriber
+        dispatch_async(dispatch_get_global_queue(DISPATCH_QUEUE_PRIORITY_BACKGROUND, 0), ^{
+            NSMutableArray *attachments = [NSMutableArray array];
+            NSData *eventData = [_SPLRemoteObjectBinaryCodec dataWithRootObject:@[ eventName, event ?: [[_SPLNil alloc] init] ] attachments:attachments];
+
+            NSArray *encodedAttachments = attachments;
+            if (self.encryptionPolicy) {
+                encodedAttachments = remoteObjectProxy_transformAttachments(attachments, ^NSData *(NSData *attachment) {
+                    return [self.encryptionPolicy dataByEncryptingData:attachment];
+                });
+            }
+
+            NSMutableDictionary *dataPackages = [NSMutableDictionary dictionary];
+            NSMutableDictionary *flagsByCodec = [NSMutableDictionary dictionary];
+
+            for (_SPLRemoteObjectNativeSocketConnection *connection in subscribers) {
+                NSNumber *codec = @(connection.compressionCodec);
+
+                if (!dataPackages[codec]) {
+                    uint8_t flags = 0;
+                    NSData *dataPackage = [_SPLRemoteObjectCompression dataByCompressingData:eventData codec:connection.compressionCodec flags:&flags];
+
+                    if (self.encryptionPolicy) {
+                        dataPackage = [self.encryptionPolicy dataByEncryptingData:dataPackage];
+                    }
+
+                    dataPackages[codec] = dataPackage;
+                    flagsByCodec[codec] = @(flags);
+                }
+
+                [connection sendDataPackage:dataPackages[codec] attachments:encodedAttachments identifier:0 type:_SPLRemoteObjectFrameTypeEvent flags:[flagsByCodec[codec] unsignedCharValue]];
+            }
+        });
+    }];
+}
+
 #pragma mark - NSNetServiceDelegate
 
 - (void)netServiceDidPublish:(NSNetService *)sender
@@ -230,113 +461,487 @@ void SPLRemoteObjectProxyServerAcceptCallback(CFSocketRef socket, CFSocketCallBa
 - (void)remoteObjectConnectionConnectionAttemptFailed:(_SPLRemoteObjectConnection *)connection
 {
     NSLog(@"[%@] %@ connection attempt failed", NSStringFromSelector(_cmd), self);
+    [(_SPLRemoteObjectNativeSocketConnection *)connection cancelAllRequests];
 
     NSMutableArray *optionConnections = _openConnections;
-    dispatch_async(dispatch_get_main_queue(), ^(void) {
+    [_eventLoop performBlock:^{
         [optionConnections removeObject:connection];
-    });
+    }];
 }
 
 - (void)remoteObjectConnectionConnectionEnded:(_SPLRemoteObjectConnection *)connection
 {
+    [(_SPLRemoteObjectNativeSocketConnection *)connection cancelAllRequests];
+
     NSMutableArray *optionConnections = _openConnections;
-    dispatch_async(dispatch_get_main_queue(), ^(void) {
+    [_eventLoop performBlock:^{
         [optionConnections removeObject:connection];
-    });
+    }];
 }
 
-- (void)remoteObjectConnection:(_SPLRemoteObjectConnection *)connection didReceiveDataPackage:(NSData *)receivedDataPackage
+- (void)remoteObjectConnection:(_SPLRemoteObjectConnection *)connection didReceiveDataPackage:(NSData *)receivedDataPackage attachments:(NSArray *)receivedAttachments header:(_SPLRemoteObjectFrameHeader)header
 {
-    dispatch_async(dispatch_get_global_queue(DISPATCH_QUEUE_PRIORITY_BACKGROUND, 0), ^{
-        NSData *dataPackage = receivedDataPackage;
+    _SPLRemoteObjectNativeSocketConnection *nativeConnection = (_SPLRemoteObjectNativeSocketConnection *)connection;
+
+    if (header.type == _SPLRemoteObjectFrameTypeHandshake) {
+        return [self _connection:nativeConnection didReceiveHandshake:receivedDataPackage];
+    } else if (header.type == _SPLRemoteObjectFrameTypeSubscription) {
+        return [self _connection:nativeConnection didReceiveSubscription:receivedDataPackage];
+    } else if (header.type == _SPLRemoteObjectFrameTypeCancel) {
+        return [nativeConnection cancelRequestWithIdentifier:header.identifier];
+    } else if (header.type != _SPLRemoteObjectFrameTypeInvocation && header.type != _SPLRemoteObjectFrameTypeBatch) {
+        return;
+    }
+
+    uint32_t identifier = header.identifier;
+    uint8_t flags = header.flags;
+    BOOL isBatch = header.type == _SPLRemoteObjectFrameTypeBatch;
+    _SPLRemoteObjectEventLoop *codingEventLoop = [self _codingEventLoopOfConnection:nativeConnection];
+
+    // registered before decoding, cancel frames are received on this thread right after their request
+    SPLRemoteObjectCancellationToken *cancellationToken = [nativeConnection beginRequestWithIdentifier:identifier];
+
+    // the remaining budget of the client is turned into a local deadline on arrival
+    NSTimeInterval budget = 0.0;
+    NSData *requestDataPackage = [_SPLRemoteObjectConnection dataPackageByRemovingDeadlineBudget:&budget fromData:receivedDataPackage flags:flags];
+    NSTimeInterval deadline = budget < 0.0 ? DBL_MAX : [NSProcessInfo processInfo].systemUptime + budget;
+
+    // every request is answered as soon as its target method completes, responses are matched to their request by identifier
+    [self _scheduleRequestWithDeadline:deadline eventLoop:codingEventLoop block:^(dispatch_group_t targetGroup) {
+        // the client already failed expired requests, they are dropped before they are decrypted and decoded
+        if (cancellationToken.isCancelled || [NSProcessInfo processInfo].systemUptime > deadline) {
+            [nativeConnection endRequestWithIdentifier:identifier];
+            return;
+        }
+
+        NSData *dataPackage = requestDataPackage;
+        NSArray *attachments = receivedAttachments;
         @try {
             if (self.encryptionPolicy) {
                 dataPackage = [self.encryptionPolicy dataByDescryptingData:dataPackage];
+                attachments = remoteObjectProxy_transformAttachments(attachments, ^NSData *(NSData *attachment) {
+                    return [self.encryptionPolicy dataByDescryptingData:attachment];
+                });
             }
+            dataPackage = [_SPLRemoteObjectCompression dataByDecompressingData:dataPackage flags:flags];
 
-            NSDictionary *dictionary = [NSKeyedUnarchiver unarchiveObjectWithData:dataPackage];
-            NSInvocation *invocation __attribute__((objc_precise_lifetime)) = [NSInvocation invocationWithRemoteObjectDictionaryRepresentation:dictionary
-                                                                                                                                   forProtocol:_protocol];
+            // answer in the same encoding the client used, large data in results is collected in `responseAttachments`
+            BOOL usesBinaryCodec = [_SPLRemoteObjectBinaryCodec isBinaryEncodedData:dataPackage];
+            NSData *(^encodeResponse)(id object, NSMutableArray *responseAttachments) = ^NSData *(id object, NSMutableArray *responseAttachments) {
+                return usesBinaryCodec ? [_SPLRemoteObjectBinaryCodec dataWithRootObject:object attachments:responseAttachments] : [NSKeyedArchiver archivedDataWithRootObject:object];
+            };
 
-            void(^sendIncompatibleResponse)(void) = ^{
-                NSData *responseData = responseData = [NSKeyedArchiver archivedDataWithRootObject:[[_SPLIncompatibleResponse alloc] init]];
+            void(^sendObject)(id object, _SPLRemoteObjectFrameType type) = ^(id object, _SPLRemoteObjectFrameType type) {
+                NSData *responseData = nil;
+                NSMutableArray *responseAttachments = [NSMutableArray array];
+                if (object == nil) {
+                    responseData = encodeResponse([[_SPLNil alloc] init], nil);
+                } else {
+                    NSAssert([object conformsToProtocol:@protocol(NSCoding)], @"object %@ must conform to NSCoding", object);
+                    responseData = encodeResponse(object, responseAttachments);
+                }
+
+                uint8_t responseFlags = 0;
+                responseData = [_SPLRemoteObjectCompression dataByCompressingData:responseData codec:nativeConnection.compressionCodec flags:&responseFlags];
 
+                NSArray *encodedAttachments = responseAttachments;
                 if (self.encryptionPolicy) {
                     responseData = [self.encryptionPolicy dataByEncryptingData:responseData];
+                    encodedAttachments = remoteObjectProxy_transformAttachments(responseAttachments, ^NSData *(NSData *attachment) {
+                        return [self.encryptionPolicy dataByEncryptingData:attachment];
+                    });
                 }
 
-                dispatch_async(dispatch_get_main_queue(), ^{
-                    [connection sendDataPackage:responseData];
-                });
+                [connection sendDataPackage:responseData attachments:encodedAttachments identifier:identifier type:type flags:responseFlags];
             };
 
-            if (![_target respondsToSelector:invocation.selector]) {
-                return sendIncompatibleResponse();
+            // requests carry the method identifier of the client, which was mapped to local methods during the handshake
+            id message = [_SPLRemoteObjectBinaryCodec rootObjectWithData:dataPackage attachments:attachments allowedClasses:_methodTable.allowedClasses];
+
+            if (!isBatch) {
+                BOOL expectsResponse = [self _performRemoteObjectMessage:message connection:nativeConnection cancellationToken:cancellationToken targetGroup:targetGroup respond:^(id response) {
+                    // nobody waits for the response of a cancelled request, it is neither archived nor encrypted
+                    if (cancellationToken.isCancelled) {
+                        return;
+                    }
+                    [nativeConnection endRequestWithIdentifier:identifier];
+
+                    if (!response) {
+                        [connection sendDataPackage:[NSData data] identifier:identifier];
+                    } else {
+                        [self _performCodingBlock:^{
+                            sendObject(response, _SPLRemoteObjectFrameTypeInvocation);
+                        } eventLoop:codingEventLoop];
+                    }
+                } streamItem:^(id item) {
+                    // items are encoded on the calling thread so that they are sent in the order the target emits them
+                    if (!cancellationToken.isCancelled) {
+                        sendObject(item, _SPLRemoteObjectFrameTypeStreamItem);
+                    }
+                }];
+
+                if (!expectsResponse) {
+                    [nativeConnection endRequestWithIdentifier:identifier];
+                }
+                return;
             }
 
-            id completionBlock = nil;
-
-            NSString *selectorName = NSStringFromSelector(invocation.selector);
-            if ([selectorName hasSuffix:@"WithResultsCompletionHandler:"] || [selectorName hasSuffix:@"withResultsCompletionHandler:"]) {
-                completionBlock = ^(id returnObject, NSError *error) {
-                    NSAssert([NSThread currentThread].isMainThread, @"completionBlock must be called on the main thread");
-
-                    dispatch_async(dispatch_get_global_queue(DISPATCH_QUEUE_PRIORITY_BACKGROUND, 0), ^{
-                        NSData *responseData = nil;
-                        if (returnObject == nil) {
-                            responseData = [NSKeyedArchiver archivedDataWithRootObject:[[_SPLNil alloc] init]];
-                        } else {
-                            NSAssert([returnObject conformsToProtocol:@protocol(NSCoding)], @"returnObject %@ must conform to NSCoding", returnObject);
-                            responseData = [NSKeyedArchiver archivedDataWithRootObject:returnObject];
-                        }
-
-                        if (self.encryptionPolicy) {
-                            responseData = [self.encryptionPolicy dataByEncryptingData:responseData];
-                        }
-
-                        dispatch_async(dispatch_get_main_queue(), ^{
-                            [connection sendDataPackage:responseData];
-                        });
-                    });
-                };
-            } else if (([selectorName hasSuffix:@"WithCompletionHandler:"] || [selectorName hasSuffix:@"withCompletionHandler:"])) {
-                completionBlock = ^(NSError *error) {
-                    NSAssert([NSThread currentThread].isMainThread, @"completionBlock must be called on the main thread");
-
-                    NSData *emptyResponseData = [NSData data];
-                    [connection sendDataPackage:emptyResponseData];
-                };
-            } else {
-                return sendIncompatibleResponse();
+            // a batch is answered once, after every invocation in it completed
+            if (![message isKindOfClass:[NSArray class]]) {
+                [NSException raise:NSInvalidArchiveOperationException format:@"batch %@ is not an array", message];
             }
 
-            [invocation setArgument:&completionBlock atIndex:invocation.methodSignature.numberOfArguments - 1];
-            [invocation retainArguments];
+            NSArray *messages = message;
+            NSMutableArray *responses = [NSMutableArray arrayWithCapacity:messages.count];
+            __block NSUInteger numberOfPendingResponses = messages.count;
 
-            dispatch_sync(dispatch_get_main_queue(), ^{
-                @try {
-                    [invocation invokeWithTarget:_target];
+            for (NSUInteger i = 0; i < messages.count; i++) {
+                [responses addObject:[[_SPLNil alloc] init]];
+            }
+
+            if (messages.count == 0) {
+                [nativeConnection endRequestWithIdentifier:identifier];
+                return sendObject(responses, _SPLRemoteObjectFrameTypeInvocation);
+            }
+
+            void(^completeResponse)(NSUInteger index, id response) = ^(NSUInteger index, id response) {
+                BOOL isComplete = NO;
+                @synchronized(responses) {
+                    responses[index] = response ?: [[_SPLNil alloc] init];
+                    isComplete = --numberOfPendingResponses == 0;
                 }
-                @catch (NSException *exception) {
-                    sendIncompatibleResponse();
+
+                if (isComplete && !cancellationToken.isCancelled) {
+                    [nativeConnection endRequestWithIdentifier:identifier];
+                    [self _performCodingBlock:^{
+                        sendObject(responses, _SPLRemoteObjectFrameTypeInvocation);
+                    } eventLoop:codingEventLoop];
                 }
-            });
+            };
+
+            [messages enumerateObjectsUsingBlock:^(id batchedMessage, NSUInteger index, BOOL *stop) {
+                BOOL expectsResponse = [self _performRemoteObjectMessage:batchedMessage connection:nativeConnection cancellationToken:cancellationToken targetGroup:targetGroup respond:^(id response) {
+                    completeResponse(index, response);
+                } streamItem:nil];
+
+                // one-way methods keep their _SPLNil placeholder
+                if (!expectsResponse) {
+                    completeResponse(index, nil);
+                }
+            }];
         } @catch (NSException *exception) {
             NSLog(@"%@", exception.reason);
             NSLog(@"%@", exception.callStackSymbols);
 
-            dispatch_async(dispatch_get_main_queue(), ^{
+            [nativeConnection cancelAllRequests];
+            [connection.eventLoop performBlock:^{
                 [connection disconnect];
-            });
+            }];
         }
-    });
+    }];
 }
 
 #pragma mark - Private category implementation ()
 
+/**
+ Requests are started earliest deadline first, requests without a deadline in the order they arrived. At most `maximumNumberOfConcurrentRequests` run at once, a request runs until the target methods it called on `targetQueue` returned, so waiting requests queue up here instead of on `targetQueue`.
+ */
+- (void)_scheduleRequestWithDeadline:(NSTimeInterval)deadline eventLoop:(_SPLRemoteObjectEventLoop *)eventLoop block:(void(^)(dispatch_group_t targetGroup))block
+{
+    _SPLRemoteObjectScheduledRequest *scheduledRequest = [[_SPLRemoteObjectScheduledRequest alloc] init];
+    scheduledRequest.deadline = deadline;
+    scheduledRequest.block = block;
+    scheduledRequest.eventLoop = eventLoop;
+
+    NSMutableArray *scheduledRequests = _scheduledRequests;
+    @synchronized(scheduledRequests) {
+        NSUInteger index = [scheduledRequests indexOfObject:scheduledRequest inSortedRange:NSMakeRange(0, scheduledRequests.count) options:NSBinarySearchingInsertionIndex | NSBinarySearchingLastEqual usingComparator:^NSComparisonResult(_SPLRemoteObjectScheduledRequest *request, _SPLRemoteObjectScheduledRequest *otherRequest) {
+            return request.deadline < otherRequest.deadline ? NSOrderedAscending : (request.deadline > otherRequest.deadline ? NSOrderedDescending : NSOrderedSame);
+        }];
+        [scheduledRequests insertObject:scheduledRequest atIndex:index];
+    }
+
+    [self _startScheduledRequests];
+}
+
+- (void)_startScheduledRequests
+{
+    NSMutableArray *startedRequests = [NSMutableArray array];
+
+    @synchronized(_scheduledRequests) {
+        while (_numberOfRunningRequests < _maximumNumberOfConcurrentRequests && _scheduledRequests.count > 0) {
+            [startedRequests addObject:_scheduledRequests.firstObject];
+            [_scheduledRequests removeObjectAtIndex:0];
+            _numberOfRunningRequests++;
+        }
+    }
+
+    for (_SPLRemoteObjectScheduledRequest *request in startedRequests) {
+        // the request enters every target call into the group before it returns itself
+        dispatch_group_t targetGroup = dispatch_group_create();
+        dispatch_group_enter(targetGroup);
+        [self _performCodingBlock:^{
+            request.block(targetGroup);
+            dispatch_group_leave(targetGroup);
+        } eventLoop:request.eventLoop];
+
+        dispatch_group_notify(targetGroup, dispatch_get_global_queue(DISPATCH_QUEUE_PRIORITY_BACKGROUND, 0), ^{
+            @synchronized(_scheduledRequests) {
+                _numberOfRunningRequests--;
+            }
+
+            [self _startScheduledRequests];
+        });
+    }
+}
+
+/**
+ Connections spread across the networking threads decrypt, decode and encode on their own thread, which keeps the work of one connection on one core. Connections on the main run loop use a global queue.
+ */
+- (_SPLRemoteObjectEventLoop *)_codingEventLoopOfConnection:(_SPLRemoteObjectConnection *)connection
+{
+    return connection.eventLoop == [_SPLRemoteObjectEventLoop mainEventLoop] ? nil : connection.eventLoop;
+}
+
+- (void)_performCodingBlock:(dispatch_block_t)block eventLoop:(_SPLRemoteObjectEventLoop *)eventLoop
+{
+    if (eventLoop) {
+        [eventLoop performBlock:block];
+    } else {
+        dispatch_async(dispatch_get_global_queue(DISPATCH_QUEUE_PRIORITY_BACKGROUND, 0), block);
+    }
+}
+
+/**
+ @return NO if `message` calls a one-way method, `respond` is never called for these.
+ */
+- (BOOL)_performRemoteObjectMessage:(id)message connection:(_SPLRemoteObjectNativeSocketConnection *)connection cancellationToken:(SPLRemoteObjectCancellationToken *)cancellationToken targetGroup:(dispatch_group_t)targetGroup respond:(void(^)(id response))respond streamItem:(void(^)(id item))streamItem
+{
+    NSArray *methods = connection.methods;
+
+    // methods with a generated skeleton or a cached IMP are called directly, everything else goes through NSInvocation
+    _SPLRemoteObjectMethod *requestedMethod = nil;
+    SPLRemoteObjectSkeleton skeleton = nil;
+    IMP implementation = NULL;
+    id target = nil;
+    NSArray *arguments = nil;
+    NSInvocation *invocation __attribute__((objc_precise_lifetime)) = nil;
+
+    if ([message isKindOfClass:[NSArray class]] && methods) {
+        NSNumber *methodIdentifier = [message firstObject];
+        if ([methodIdentifier isKindOfClass:[NSNumber class]] && methodIdentifier.unsignedIntegerValue < methods.count) {
+            requestedMethod = methods[methodIdentifier.unsignedIntegerValue];
+        }
+
+        if ([requestedMethod isKindOfClass:[_SPLRemoteObjectMethod class]] && [message count] - 1 == requestedMethod.numberOfObjectArguments) {
+            arguments = [message subarrayWithRange:NSMakeRange(1, [message count] - 1)];
+            skeleton = requestedMethod.skeleton;
+
+            if (!skeleton && requestedMethod.hasOnlyObjectArguments && arguments.count <= SPLRemoteObjectProxyMaximumNumberOfDirectArguments) {
+                target = _target;
+                implementation = [self _implementationOfMethod:requestedMethod target:target];
+            }
+        }
+
+        if (!skeleton && !implementation) {
+            invocation = [NSInvocation invocationWithRemoteObjectMessage:message methods:methods];
+        }
+    }
+
+    // one-way methods are never answered, not even if they fail
+    BOOL isOneway = [requestedMethod isKindOfClass:[_SPLRemoteObjectMethod class]] && requestedMethod.completionHandlerKind == _SPLRemoteObjectCompletionHandlerKindOneway;
+
+    void(^sendIncompatibleResponse)(void) = ^{
+        if (!isOneway) {
+            respond([[_SPLIncompatibleResponse alloc] init]);
+        }
+    };
+
+    SEL selector = invocation ? invocation.selector : requestedMethod.selector;
+    if ((!skeleton && !implementation && !invocation) || ![_target respondsToSelector:selector]) {
+        sendIncompatibleResponse();
+        return !isOneway;
+    }
+
+    id completionBlock = nil;
+
+    // a nil response is sent as an empty frame, nil results are sent as _SPLNil
+    _SPLRemoteObjectMethod *method = [_methodTable methodForSelector:selector];
+    if (method.completionHandlerKind == _SPLRemoteObjectCompletionHandlerKindResults) {
+        completionBlock = ^(id returnObject, NSError *error) {
+            respond(returnObject ?: [[_SPLNil alloc] init]);
+        };
+    } else if (method.completionHandlerKind == _SPLRemoteObjectCompletionHandlerKindStreamingResults && streamItem) {
+        completionBlock = ^(id item, BOOL finished, NSError *error) {
+            if (finished) {
+                respond(nil);
+            } else {
+                streamItem(item);
+            }
+        };
+    } else if (method.completionHandlerKind == _SPLRemoteObjectCompletionHandlerKindError) {
+        completionBlock = ^(NSError *error) {
+            respond(nil);
+        };
+    } else if (method.completionHandlerKind != _SPLRemoteObjectCompletionHandlerKindOneway) {
+        sendIncompatibleResponse();
+        return YES;
+    }
+
+    if (skeleton) {
+        dispatch_group_async(targetGroup, self.targetQueue, ^{
+            @try {
+                [SPLRemoteObjectCancellationToken performWithCurrentToken:cancellationToken block:^{
+                    skeleton(_target, arguments, completionBlock);
+                }];
+            }
+            @catch (NSException *exception) {
+                sendIncompatibleResponse();
+            }
+        });
+        return !isOneway;
+    }
+
+    if (implementation) {
+        dispatch_group_async(targetGroup, self.targetQueue, ^{
+            @try {
+                [SPLRemoteObjectCancellationToken performWithCurrentToken:cancellationToken block:^{
+                    if (isOneway) {
+                        remoteObjectProxy_callOnewayImplementation(implementation, target, selector, arguments);
+                    } else {
+                        remoteObjectProxy_callImplementation(implementation, target, selector, arguments, completionBlock);
+                    }
+                }];
+            }
+            @catch (NSException *exception) {
+                sendIncompatibleResponse();
+            }
+        });
+        return !isOneway;
+    }
+
+    if (!isOneway) {
+        [invocation setArgument:&completionBlock atIndex:invocation.methodSignature.numberOfArguments - 1];
+    }
+    [invocation retainArguments];
+
+    dispatch_group_async(targetGroup, self.targetQueue, ^{
+        @try {
+            [SPLRemoteObjectCancellationToken performWithCurrentToken:cancellationToken block:^{
+                [invocation invokeWithTarget:_target];
+            }];
+        }
+        @catch (NSException *exception) {
+            sendIncompatibleResponse();
+        }
+    });
+
+    return !isOneway;
+}
+
+- (IMP)_implementationOfMethod:(_SPLRemoteObjectMethod *)method target:(id)target
+{
+    if (!target) {
+        return NULL;
+    }
+
+    Class class = object_getClass(target);
+
+    pthread_mutex_lock(&_implementationsLock);
+    if (class != _implementationsClass) {
+        memset(_implementations, 0, _methodTable.methods.count * sizeof(IMP));
+        _implementationsClass = class;
+    }
+
+    IMP implementation = _implementations[method.identifier];
+    if (implementation == NULL && [target respondsToSelector:method.selector]) {
+        implementation = class_getMethodImplementation(class, method.selector);
+        _implementations[method.identifier] = implementation;
+    }
+    pthread_mutex_unlock(&_implementationsLock);
+
+    return implementation;
+}
+
+- (void)_connection:(_SPLRemoteObjectNativeSocketConnection *)connection didReceiveHandshake:(NSData *)dataPackage
+{
+    @try {
+        if (self.encryptionPolicy) {
+            dataPackage = [self.encryptionPolicy dataByDescryptingData:dataPackage];
+        }
+
+        NSDictionary *handshake = [_SPLRemoteObjectBinaryCodec rootObjectWithData:dataPackage];
+        if (![handshake isKindOfClass:[NSDictionary class]] || [handshake[@"version"] integerValue] != _SPLRemoteObjectHandshakeVersion) {
+            NSLog(@"[%@] unsupported handshake %@ => disconnecting", NSStringFromSelector(_cmd), handshake);
+            [connection disconnect];
+            [self remoteObjectConnectionConnectionEnded:connection];
+            return;
+        }
+
+        // hashes are checked once per connection instead of once per request
+        NSArray *methods = [_methodTable methodsMatchingHandshakeRepresentation:handshake[@"methods"]];
+        connection.methods = methods;
+        connection.compressionCodec = [_SPLRemoteObjectCompression preferredCodecWithNames:handshake[@"compression"]];
+
+        NSMutableArray *incompatibleMethods = [NSMutableArray array];
+        [methods enumerateObjectsUsingBlock:^(id method, NSUInteger index, BOOL *stop) {
+            if (method == [NSNull null] || ![_target respondsToSelector:[method selector]]) {
+                [incompatibleMethods addObject:@(index)];
+            }
+        }];
+
+        NSDictionary *response = @{
+                                   @"version": @(_SPLRemoteObjectHandshakeVersion),
+                                   @"incompatible_methods": incompatibleMethods,
+                                   @"compression": [_SPLRemoteObjectCompression nameOfCodec:connection.compressionCodec] ?: [[_SPLNil alloc] init],
+                                   };
+
+        NSData *responseData = [_SPLRemoteObjectBinaryCodec dataWithRootObject:response];
+        if (self.encryptionPolicy) {
+            responseData = [self.encryptionPolicy dataByEncryptingData:responseData];
+        }
+
+        [connection sendDataPackage:responseData identifier:0 type:_SPLRemoteObjectFrameTypeHandshake flags:0];
+    } @catch (NSException *exception) {
+        NSLog(@"[%@] invalid handshake: %@", NSStringFromSelector(_cmd), exception.reason);
+        [connection disconnect];
+        [self remoteObjectConnectionConnectionEnded:connection];
+    }
+}
+
+- (void)_connection:(_SPLRemoteObjectNativeSocketConnection *)connection didReceiveSubscription:(NSData *)dataPackage
+{
+    @try {
+        if (self.encryptionPolicy) {
+            dataPackage = [self.encryptionPolicy dataByDescryptingData:dataPackage];
+        }
+
+        NSArray *eventNames = [_SPLRemoteObjectBinaryCodec rootObjectWithData:dataPackage];
+        if (![eventNames isKindOfClass:[NSArray class]]) {
+            [NSException raise:NSInvalidArchiveOperationException format:@"subscription %@ is not an array", eventNames];
+        }
+
+        NSMutableSet *subscribedEventNames = [NSMutableSet setWithCapacity:eventNames.count];
+        for (NSString *eventName in eventNames) {
+            if ([eventName isKindOfClass:[NSString class]]) {
+                [subscribedEventNames addObject:eventName];
+            }
+        }
+
+        connection.subscribedEventNames = subscribedEventNames;
+    } @catch (NSException *exception) {
+        NSLog(@"[%@] invalid subscription: %@", NSStringFromSelector(_cmd), exception.reason);
+        [connection disconnect];
+        [self remoteObjectConnectionConnectionEnded:connection];
+    }
+}
+
 - (void)_acceptConnectionFromNewNativeSocket:(CFSocketNativeHandle)nativeSocketHandle
 {
     _SPLRemoteObjectNativeSocketConnection *connection = [[_SPLRemoteObjectNativeSocketConnection alloc] initWithNativeSocketHandle:nativeSocketHandle];
+
+    // spread accepted connections across all networking threads, each one frames its own connections
+    connection.eventLoop = self.usesDedicatedNetworkThread ? [_SPLRemoteObjectEventLoop nextNetworkEventLoop] : _eventLoop;
     connection.delegate = self;
 
     [_openConnections addObject:connection];
@@ -385,9 +990,10 @@ void SPLRemoteObjectProxyServerAcceptCallback(CFSocketRef socket, CFSocketCallBa
 
     _port = ntohs(socketAddressActual.sin_port);
 
-    CFRunLoopRef currentRunLoop = CFRunLoopGetCurrent();
+    // connections are accepted on the event loop, they are scheduled in its run loop as well
     CFRunLoopSourceRef runLoopSource = CFSocketCreateRunLoopSource(kCFAllocatorDefault, _socket, 0);
-    CFRunLoopAddSource(currentRunLoop, runLoopSource, kCFRunLoopCommonModes);
+    CFRunLoopAddSource(_eventLoop.runLoop.getCFRunLoop, runLoopSource, kCFRunLoopCommonModes);
+    self.socketRunLoopSource = runLoopSource;
     CFRelease(runLoopSource);
 }
 
@@ -407,6 +1013,7 @@ void SPLRemoteObjectProxyServerAcceptCallback(CFSocketRef socket, CFSocketCallBa
     if (_socket != NULL) {
         CFSocketInvalidate(_socket);
         self.socket = NULL;
+        self.socketRunLoopSource = NULL;
     }
 }
 
@@ -419,6 +1026,12 @@ void SPLRemoteObjectProxyServerAcceptCallback(CFSocketRef socket, CFSocketCallBa
 
 @end
 
+
+
+@implementation _SPLRemoteObjectScheduledRequest
+
+@end
+
 void SPLRemoteObjectProxyServerAcceptCallback(CFSocketRef socket, CFSocketCallBackType type, CFDataRef address, const void *data, void *info)
 {
     SPLRemoteObjectProxy *host = (__bridge SPLRemoteObjectProxy *)info;
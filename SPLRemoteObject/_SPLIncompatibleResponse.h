@@ -31,7 +31,7 @@ NS_ASSUME_NONNULL_BEGIN
 /**
  @abstract  <#abstract comment#>
  */
-@interface _SPLIncompatibleResponse : NSObject <NSCoding>
+@interface _SPLIncompatibleResponse : NSObject <NSSecureCoding>
 
 @end
 
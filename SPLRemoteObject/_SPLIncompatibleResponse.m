@@ -28,7 +28,12 @@
 
 @implementation _SPLIncompatibleResponse
 
-#pragma mark - NSCoding
+#pragma mark - NSSecureCoding
+
++ (BOOL)supportsSecureCoding
+{
+    return YES;
+}
 
 - (void)encodeWithCoder:(NSCoder *)encoder
 {
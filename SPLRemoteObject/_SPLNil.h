@@ -31,7 +31,7 @@ NS_ASSUME_NONNULL_BEGIN
 /**
  @abstract  <#abstract comment#>
  */
-@interface _SPLNil : NSObject <NSCoding>
+@interface _SPLNil : NSObject <NSSecureCoding>
 
 @end
 
@@ -0,0 +1,74 @@
+//
+//  _SPLRemoteObjectBinaryCodec.h
+//  SPLRemoteObject
+//
+//  The MIT License (MIT)
+//  Copyright (c) 2013 Oliver Letterer, Sparrow-Labs
+//
+//  Permission is hereby granted, free of charge, to any person obtaining a copy
+//  of this software and associated documentation files (the "Software"), to deal
+//  in the Software without restriction, including without limitation the rights
+//  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+//  copies of the Software, and to permit persons to whom the Software is
+//  furnished to do so, subject to the following conditions:
+//
+//  The above copyright notice and this permission notice shall be included in
+//  all copies or substantial portions of the Software.
+//
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+//  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+//  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+//  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+//  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+//  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+//  THE SOFTWARE.
+//
+
+#import <Foundation/Foundation.h>
+
+NS_ASSUME_NONNULL_BEGIN
+
+/**
+ NSData objects of at least this size are sent as attachments if the caller collects them.
+ */
+static NSUInteger const _SPLRemoteObjectBinaryCodecAttachmentThreshold = 64 * 1024;
+
+/**
+ @abstract  Compact, versioned binary encoding for invocations and responses. NSString, NSNumber, NSData, NSDate, NSArray and NSDictionary are encoded natively, every other object including NSNumber subclasses like NSDecimalNumber is embedded as a keyed archive. nil is represented by _SPLNil.
+ */
+@interface _SPLRemoteObjectBinaryCodec : NSObject
+
++ (NSData *)dataWithRootObject:(id)rootObject;
+
+/**
+ @abstract  Large NSData objects are not copied into the encoded data but referenced by their index in `attachments`, which the caller sends as separate frames.
+ */
++ (NSData *)dataWithRootObject:(id)rootObject attachments:(nullable NSMutableArray<NSData *> *)attachments;
+
+/**
+ @abstract  Decodes binary encoded data and falls back to NSKeyedUnarchiver for keyed archives of older peers. Throws NSInvalidArchiveOperationException for malformed data.
+ */
++ (nullable id)rootObjectWithData:(NSData *)data;
++ (nullable id)rootObjectWithData:(NSData *)data attachments:(nullable NSArray<NSData *> *)attachments;
+
+/**
+ @abstract  Keyed archives are decoded with secure coding and may only contain Foundation property list classes, NSNull, NSURL, NSUUID, NSValue, NSError and `allowedClasses`. Throws NSInvalidUnarchiveOperationException for any other class.
+ */
++ (nullable id)rootObjectWithData:(NSData *)data attachments:(nullable NSArray<NSData *> *)attachments allowedClasses:(nullable NSSet<Class> *)allowedClasses;
+
++ (BOOL)isBinaryEncodedData:(NSData *)data;
+
+/**
+ @abstract  Raw little-endian encoding of scalar and struct arguments, described by their Objective-C type encoding. Struct fields are written one after another without padding.
+ */
++ (BOOL)supportsValueOfType:(const char *)type;
++ (NSData *)dataWithValue:(const void *)value ofType:(const char *)type;
+
+/**
+ @return NO if the length of `data` does not match `type`.
+ */
++ (BOOL)getValue:(void *)value ofType:(const char *)type fromData:(NSData *)data;
+
+@end
+
+NS_ASSUME_NONNULL_END
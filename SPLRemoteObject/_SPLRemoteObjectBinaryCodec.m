@@ -0,0 +1,564 @@
+//
+//  _SPLRemoteObjectBinaryCodec.m
+//  SPLRemoteObject
+//
+//  The MIT License (MIT)
+//  Copyright (c) 2013 Oliver Letterer, Sparrow-Labs
+//
+//  Permission is hereby granted, free of charge, to any person obtaining a copy
+//  of this software and associated documentation files (the "Software"), to deal
+//  in the Software without restriction, including without limitation the rights
+//  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+//  copies of the Software, and to permit persons to whom the Software is
+//  furnished to do so, subject to the following conditions:
+//
+//  The above copyright notice and this permission notice shall be included in
+//  all copies or substantial portions of the Software.
+//
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+//  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+//  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+//  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+//  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+//  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+//  THE SOFTWARE.
+//
+
+#import "_SPLRemoteObjectBinaryCodec.h"
+#import "_SPLNil.h"
+#import "_SPLIncompatibleResponse.h"
+#import <libkern/OSByteOrder.h>
+
+// keyed archives start with "bplist", this byte can never start one
+static uint8_t const _SPLRemoteObjectBinaryCodecMagic = 0xb1;
+static uint8_t const _SPLRemoteObjectBinaryCodecVersion = 1;
+
+static NSUInteger const _SPLRemoteObjectBinaryCodecMaximumDepth = 64;
+
+// frame headers count attachments in 16 bits
+static NSUInteger const _SPLRemoteObjectBinaryCodecMaximumNumberOfAttachments = UINT16_MAX;
+
+typedef NS_ENUM(uint8_t, _SPLRemoteObjectBinaryCodecTag) {
+    _SPLRemoteObjectBinaryCodecTagNil = 0,
+    _SPLRemoteObjectBinaryCodecTagString,
+    _SPLRemoteObjectBinaryCodecTagInteger,
+    _SPLRemoteObjectBinaryCodecTagDouble,
+    _SPLRemoteObjectBinaryCodecTagTrue,
+    _SPLRemoteObjectBinaryCodecTagFalse,
+    _SPLRemoteObjectBinaryCodecTagData,
+    _SPLRemoteObjectBinaryCodecTagDate,
+    _SPLRemoteObjectBinaryCodecTagArray,
+    _SPLRemoteObjectBinaryCodecTagDictionary,
+    _SPLRemoteObjectBinaryCodecTagArchivedObject,
+    _SPLRemoteObjectBinaryCodecTagAttachment,
+};
+
+typedef struct {
+    const uint8_t *bytes;
+    NSUInteger length;
+    NSUInteger offset;
+    __unsafe_unretained NSArray *attachments;
+    __unsafe_unretained NSSet *allowedClasses;
+} _SPLRemoteObjectBinaryCodecReader;
+
+
+
+static void raiseMalformedData(NSString *reason)
+{
+    [NSException raise:NSInvalidArchiveOperationException format:@"malformed binary encoded data: %@", reason];
+}
+
+static NSSet *defaultAllowedClasses(void)
+{
+    static NSSet *allowedClasses = nil;
+    static dispatch_once_t onceToken;
+    dispatch_once(&onceToken, ^{
+        allowedClasses = [NSSet setWithObjects:[NSArray class], [NSDictionary class], [NSSet class], [NSOrderedSet class], [NSString class], [NSNumber class], [NSData class], [NSDate class], [NSNull class], [NSURL class], [NSUUID class], [NSValue class], [NSError class], [_SPLNil class], [_SPLIncompatibleResponse class], nil];
+    });
+
+    return allowedClasses;
+}
+
+// never instantiates classes outside of `allowedClasses` and the default classes, peers control the archived class names
+static id unarchiveObject(NSData *data, NSSet *allowedClasses)
+{
+    NSSet *classes = allowedClasses.count > 0 ? [defaultAllowedClasses() setByAddingObjectsFromSet:allowedClasses] : defaultAllowedClasses();
+
+    NSKeyedUnarchiver *unarchiver = [[NSKeyedUnarchiver alloc] initForReadingWithData:data];
+    unarchiver.requiresSecureCoding = YES;
+
+    id object = [unarchiver decodeObjectOfClasses:classes forKey:NSKeyedArchiveRootObjectKey];
+    [unarchiver finishDecoding];
+
+    return object;
+}
+
+#pragma mark - Writing
+
+static void writeByte(NSMutableData *data, uint8_t byte)
+{
+    [data appendBytes:&byte length:sizeof(byte)];
+}
+
+static void writeVarint(NSMutableData *data, uint64_t value)
+{
+    uint8_t buffer[10];
+    size_t length = 0;
+
+    do {
+        uint8_t byte = value & 0x7f;
+        value >>= 7;
+        buffer[length++] = value ? (byte | 0x80) : byte;
+    } while (value);
+
+    [data appendBytes:buffer length:length];
+}
+
+static void writeDouble(NSMutableData *data, double value)
+{
+    uint64_t bits = 0;
+    memcpy(&bits, &value, sizeof(bits));
+    bits = OSSwapHostToLittleInt64(bits);
+
+    [data appendBytes:&bits length:sizeof(bits)];
+}
+
+static void writeBytes(NSMutableData *data, const void *bytes, NSUInteger length)
+{
+    writeVarint(data, length);
+    [data appendBytes:bytes length:length];
+}
+
+static void writeString(NSMutableData *data, NSString *string)
+{
+    NSUInteger length = [string lengthOfBytesUsingEncoding:NSUTF8StringEncoding];
+    writeVarint(data, length);
+
+    NSUInteger offset = data.length;
+    [data increaseLengthBy:length];
+    [string getBytes:(uint8_t *)data.mutableBytes + offset maxLength:length usedLength:NULL encoding:NSUTF8StringEncoding options:0 range:NSMakeRange(0, string.length) remainingRange:NULL];
+}
+
+// subclasses like NSDecimalNumber can not be represented by an integer or double without losing precision
+static BOOL isFoundationNumber(id object)
+{
+    static Class numberClasses[3];
+    static dispatch_once_t onceToken;
+    dispatch_once(&onceToken, ^{
+        numberClasses[0] = [@0 class];
+        numberClasses[1] = [@(LLONG_MAX) class];
+        numberClasses[2] = [@YES class];
+    });
+
+    Class class = [object class];
+    return class == numberClasses[0] || class == numberClasses[1] || class == numberClasses[2];
+}
+
+static void writeObject(NSMutableData *data, id object, NSMutableArray *attachments)
+{
+    BOOL isNumber = isFoundationNumber(object);
+
+    if (!object || [object isKindOfClass:[_SPLNil class]]) {
+        writeByte(data, _SPLRemoteObjectBinaryCodecTagNil);
+    } else if ([object isKindOfClass:[NSString class]]) {
+        writeByte(data, _SPLRemoteObjectBinaryCodecTagString);
+        writeString(data, object);
+    } else if (isNumber && (object == (id)kCFBooleanTrue || object == (id)kCFBooleanFalse)) {
+        writeByte(data, object == (id)kCFBooleanTrue ? _SPLRemoteObjectBinaryCodecTagTrue : _SPLRemoteObjectBinaryCodecTagFalse);
+    } else if (isNumber && CFNumberIsFloatType((__bridge CFNumberRef)object)) {
+        writeByte(data, _SPLRemoteObjectBinaryCodecTagDouble);
+        writeDouble(data, [object doubleValue]);
+    } else if (isNumber && !(strcmp([object objCType], @encode(unsigned long long)) == 0 && [object unsignedLongLongValue] > LLONG_MAX)) {
+        // zigzag encoding keeps small negative numbers small
+        int64_t value = [object longLongValue];
+        writeByte(data, _SPLRemoteObjectBinaryCodecTagInteger);
+        writeVarint(data, ((uint64_t)value << 1) ^ (uint64_t)(value >> 63));
+    } else if ([object isKindOfClass:[NSData class]] && attachments && [object length] >= _SPLRemoteObjectBinaryCodecAttachmentThreshold && attachments.count < _SPLRemoteObjectBinaryCodecMaximumNumberOfAttachments) {
+        // large data is sent in its own frame instead of being copied into this one
+        writeByte(data, _SPLRemoteObjectBinaryCodecTagAttachment);
+        writeVarint(data, attachments.count);
+        [attachments addObject:[object copy]];
+    } else if ([object isKindOfClass:[NSData class]]) {
+        writeByte(data, _SPLRemoteObjectBinaryCodecTagData);
+        writeBytes(data, [object bytes], [object length]);
+    } else if ([object isKindOfClass:[NSDate class]]) {
+        writeByte(data, _SPLRemoteObjectBinaryCodecTagDate);
+        writeDouble(data, [object timeIntervalSinceReferenceDate]);
+    } else if ([object isKindOfClass:[NSArray class]]) {
+        writeByte(data, _SPLRemoteObjectBinaryCodecTagArray);
+        writeVarint(data, [object count]);
+
+        for (id element in object) {
+            writeObject(data, element, attachments);
+        }
+    } else if ([object isKindOfClass:[NSDictionary class]]) {
+        writeByte(data, _SPLRemoteObjectBinaryCodecTagDictionary);
+        writeVarint(data, [object count]);
+
+        [object enumerateKeysAndObjectsUsingBlock:^(id key, id value, BOOL *stop) {
+            writeObject(data, key, attachments);
+            writeObject(data, value, attachments);
+        }];
+    } else {
+        NSCAssert([object conformsToProtocol:@protocol(NSSecureCoding)], @"object %@ must conform to NSSecureCoding", object);
+
+        NSData *archivedData = [NSKeyedArchiver archivedDataWithRootObject:object];
+        writeByte(data, _SPLRemoteObjectBinaryCodecTagArchivedObject);
+        writeBytes(data, archivedData.bytes, archivedData.length);
+    }
+}
+
+#pragma mark - Reading
+
+static uint8_t readByte(_SPLRemoteObjectBinaryCodecReader *reader)
+{
+    if (reader->offset >= reader->length) {
+        raiseMalformedData(@"unexpected end of data");
+    }
+
+    return reader->bytes[reader->offset++];
+}
+
+static uint64_t readVarint(_SPLRemoteObjectBinaryCodecReader *reader)
+{
+    uint64_t value = 0;
+
+    for (NSUInteger shift = 0; shift < 64; shift += 7) {
+        uint8_t byte = readByte(reader);
+        value |= (uint64_t)(byte & 0x7f) << shift;
+
+        if (!(byte & 0x80)) {
+            return value;
+        }
+    }
+
+    raiseMalformedData(@"varint too long");
+    return 0;
+}
+
+static NSUInteger readLength(_SPLRemoteObjectBinaryCodecReader *reader)
+{
+    uint64_t length = readVarint(reader);
+    if (length > reader->length - reader->offset) {
+        raiseMalformedData(@"length exceeds data");
+    }
+
+    return (NSUInteger)length;
+}
+
+static double readDouble(_SPLRemoteObjectBinaryCodecReader *reader)
+{
+    if (reader->length - reader->offset < sizeof(uint64_t)) {
+        raiseMalformedData(@"unexpected end of data");
+    }
+
+    uint64_t bits = 0;
+    memcpy(&bits, reader->bytes + reader->offset, sizeof(bits));
+    reader->offset += sizeof(bits);
+
+    bits = OSSwapLittleToHostInt64(bits);
+
+    double value = 0.0;
+    memcpy(&value, &bits, sizeof(value));
+    return value;
+}
+
+static id readObject(_SPLRemoteObjectBinaryCodecReader *reader, NSUInteger depth)
+{
+    if (depth > _SPLRemoteObjectBinaryCodecMaximumDepth) {
+        raiseMalformedData(@"objects nested too deeply");
+    }
+
+    _SPLRemoteObjectBinaryCodecTag tag = readByte(reader);
+
+    switch (tag) {
+        case _SPLRemoteObjectBinaryCodecTagNil:
+            return [[_SPLNil alloc] init];
+        case _SPLRemoteObjectBinaryCodecTagString: {
+            NSUInteger length = readLength(reader);
+            NSString *string = [[NSString alloc] initWithBytes:reader->bytes + reader->offset length:length encoding:NSUTF8StringEncoding];
+            reader->offset += length;
+
+            if (!string) {
+                raiseMalformedData(@"invalid UTF-8 string");
+            }
+
+            return string;
+        }
+        case _SPLRemoteObjectBinaryCodecTagInteger: {
+            uint64_t value = readVarint(reader);
+            return @((int64_t)(value >> 1) ^ -(int64_t)(value & 1));
+        }
+        case _SPLRemoteObjectBinaryCodecTagDouble:
+            return @(readDouble(reader));
+        case _SPLRemoteObjectBinaryCodecTagTrue:
+            return @YES;
+        case _SPLRemoteObjectBinaryCodecTagFalse:
+            return @NO;
+        case _SPLRemoteObjectBinaryCodecTagData: {
+            NSUInteger length = readLength(reader);
+            NSData *data = [NSData dataWithBytes:reader->bytes + reader->offset length:length];
+            reader->offset += length;
+
+            return data;
+        }
+        case _SPLRemoteObjectBinaryCodecTagDate:
+            return [NSDate dateWithTimeIntervalSinceReferenceDate:readDouble(reader)];
+        case _SPLRemoteObjectBinaryCodecTagArray: {
+            // every element takes at least one byte
+            NSUInteger count = readLength(reader);
+            NSMutableArray *array = [NSMutableArray arrayWithCapacity:count];
+
+            for (NSUInteger i = 0; i < count; i++) {
+                [array addObject:readObject(reader, depth + 1)];
+            }
+
+            return array;
+        }
+        case _SPLRemoteObjectBinaryCodecTagDictionary: {
+            NSUInteger count = readLength(reader);
+            NSMutableDictionary *dictionary = [NSMutableDictionary dictionaryWithCapacity:count];
+
+            for (NSUInteger i = 0; i < count; i++) {
+                id key = readObject(reader, depth + 1);
+                id value = readObject(reader, depth + 1);
+
+                if (![key conformsToProtocol:@protocol(NSCopying)]) {
+                    raiseMalformedData(@"dictionary key does not conform to NSCopying");
+                }
+
+                dictionary[key] = value;
+            }
+
+            return dictionary;
+        }
+        case _SPLRemoteObjectBinaryCodecTagArchivedObject: {
+            NSUInteger length = readLength(reader);
+            NSData *archivedData = [NSData dataWithBytesNoCopy:(void *)(reader->bytes + reader->offset) length:length freeWhenDone:NO];
+            reader->offset += length;
+
+            id object = unarchiveObject(archivedData, reader->allowedClasses);
+            return object ?: [[_SPLNil alloc] init];
+        }
+        case _SPLRemoteObjectBinaryCodecTagAttachment: {
+            uint64_t index = readVarint(reader);
+            if (index >= reader->attachments.count) {
+                raiseMalformedData(@"missing attachment");
+            }
+
+            return reader->attachments[(NSUInteger)index];
+        }
+    }
+
+    raiseMalformedData([NSString stringWithFormat:@"unknown tag %d", tag]);
+    return nil;
+}
+
+#pragma mark - Values
+
+static const char *skipTypeQualifiers(const char *type)
+{
+    while (*type != '\0' && strchr("rnNoORV", *type) != NULL) {
+        type++;
+    }
+
+    return type;
+}
+
+static NSUInteger scalarSize(char type)
+{
+    switch (type) {
+        case 'c': case 'C': case 'B':
+            return 1;
+        case 's': case 'S':
+            return 2;
+        case 'i': case 'I': case 'l': case 'L': case 'f':
+            return 4;
+        case 'q': case 'Q': case 'd':
+            return 8;
+        default:
+            return 0;
+    }
+}
+
+// 0 for unsupported types, `end` points behind the type
+static NSUInteger valueAlignment(const char *type, const char **end)
+{
+    type = skipTypeQualifiers(type);
+
+    if (*type == '{') {
+        while (*type != '\0' && *type != '=' && *type != '}') {
+            type++;
+        }
+
+        // opaque structs do not describe their fields
+        if (*type != '=') {
+            return 0;
+        }
+        type++;
+
+        NSUInteger alignment = 1;
+        while (*type != '}') {
+            NSUInteger fieldAlignment = valueAlignment(type, &type);
+            if (fieldAlignment == 0) {
+                return 0;
+            }
+
+            alignment = MAX(alignment, fieldAlignment);
+        }
+
+        *end = type + 1;
+        return alignment;
+    }
+
+    *end = type + 1;
+    return scalarSize(*type);
+}
+
+static void copyLittleEndian(uint8_t *destination, const uint8_t *source, NSUInteger size)
+{
+#if __LITTLE_ENDIAN__
+    memcpy(destination, source, size);
+#else
+    for (NSUInteger i = 0; i < size; i++) {
+        destination[i] = source[size - 1 - i];
+    }
+#endif
+}
+
+// copies between the in memory layout and the packed wire layout, only measures if `value` or `bytes` is NULL
+static const char *transferValue(const char *type, uint8_t *value, NSUInteger *valueOffset, uint8_t *bytes, NSUInteger *bytesOffset, BOOL encode)
+{
+    const char *end = NULL;
+    NSUInteger alignment = valueAlignment(type, &end);
+    if (alignment == 0) {
+        return NULL;
+    }
+
+    *valueOffset = (*valueOffset + alignment - 1) / alignment * alignment;
+    type = skipTypeQualifiers(type);
+
+    if (*type == '{') {
+        type = strchr(type, '=') + 1;
+        while (*type != '}') {
+            type = transferValue(type, value, valueOffset, bytes, bytesOffset, encode);
+        }
+
+        *valueOffset = (*valueOffset + alignment - 1) / alignment * alignment;
+        return end;
+    }
+
+    NSUInteger size = scalarSize(*type);
+    if (value && bytes) {
+        if (encode) {
+            copyLittleEndian(bytes + *bytesOffset, value + *valueOffset, size);
+        } else {
+            copyLittleEndian(value + *valueOffset, bytes + *bytesOffset, size);
+        }
+    }
+
+    *valueOffset += size;
+    *bytesOffset += size;
+    return end;
+}
+
+
+
+@implementation _SPLRemoteObjectBinaryCodec
+
++ (NSData *)dataWithRootObject:(id)rootObject
+{
+    return [self dataWithRootObject:rootObject attachments:nil];
+}
+
++ (NSData *)dataWithRootObject:(id)rootObject attachments:(NSMutableArray *)attachments
+{
+    NSMutableData *data = [NSMutableData dataWithCapacity:128];
+    writeByte(data, _SPLRemoteObjectBinaryCodecMagic);
+    writeByte(data, _SPLRemoteObjectBinaryCodecVersion);
+    writeObject(data, rootObject, attachments);
+
+    return data;
+}
+
++ (id)rootObjectWithData:(NSData *)data
+{
+    return [self rootObjectWithData:data attachments:nil];
+}
+
++ (id)rootObjectWithData:(NSData *)data attachments:(NSArray *)attachments
+{
+    return [self rootObjectWithData:data attachments:attachments allowedClasses:nil];
+}
+
++ (id)rootObjectWithData:(NSData *)data attachments:(NSArray *)attachments allowedClasses:(NSSet *)allowedClasses
+{
+    if (![self isBinaryEncodedData:data]) {
+        return unarchiveObject(data, allowedClasses);
+    }
+
+    const uint8_t *bytes = data.bytes;
+    if (bytes[1] != _SPLRemoteObjectBinaryCodecVersion) {
+        raiseMalformedData([NSString stringWithFormat:@"unsupported version %d", bytes[1]]);
+    }
+
+    _SPLRemoteObjectBinaryCodecReader reader = { bytes, data.length, 2, attachments, allowedClasses };
+    id rootObject = readObject(&reader, 0);
+
+    if (reader.offset != reader.length) {
+        raiseMalformedData(@"trailing bytes");
+    }
+
+    return rootObject;
+}
+
++ (BOOL)isBinaryEncodedData:(NSData *)data
+{
+    return data.length >= 2 && ((const uint8_t *)data.bytes)[0] == _SPLRemoteObjectBinaryCodecMagic;
+}
+
++ (BOOL)supportsValueOfType:(const char *)type
+{
+    NSParameterAssert(type);
+
+    const char *end = NULL;
+    return valueAlignment(type, &end) != 0 && *end == '\0';
+}
+
++ (NSData *)dataWithValue:(const void *)value ofType:(const char *)type
+{
+    NSParameterAssert(value);
+
+    NSUInteger valueOffset = 0;
+    NSUInteger length = 0;
+    if (![self supportsValueOfType:type] || !transferValue(type, NULL, &valueOffset, NULL, &length, YES)) {
+        [NSException raise:NSInvalidArgumentException format:@"values of type %s are not supported", type];
+    }
+
+    NSMutableData *data = [NSMutableData dataWithLength:length];
+
+    valueOffset = 0;
+    length = 0;
+    transferValue(type, (uint8_t *)value, &valueOffset, data.mutableBytes, &length, YES);
+
+    return data;
+}
+
++ (BOOL)getValue:(void *)value ofType:(const char *)type fromData:(NSData *)data
+{
+    NSParameterAssert(value);
+
+    NSUInteger valueOffset = 0;
+    NSUInteger length = 0;
+    if (![self supportsValueOfType:type] || !transferValue(type, NULL, &valueOffset, NULL, &length, NO) || length != data.length) {
+        return NO;
+    }
+
+    valueOffset = 0;
+    length = 0;
+    transferValue(type, value, &valueOffset, (uint8_t *)data.bytes, &length, NO);
+
+    return YES;
+}
+
+@end
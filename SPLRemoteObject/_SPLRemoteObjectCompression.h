@@ -0,0 +1,74 @@
+//
+//  _SPLRemoteObjectCompression.h
+//  SPLRemoteObject
+//
+//  The MIT License (MIT)
+//  Copyright (c) 2013 Oliver Letterer, Sparrow-Labs
+//
+//  Permission is hereby granted, free of charge, to any person obtaining a copy
+//  of this software and associated documentation files (the "Software"), to deal
+//  in the Software without restriction, including without limitation the rights
+//  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+//  copies of the Software, and to permit persons to whom the Software is
+//  furnished to do so, subject to the following conditions:
+//
+//  The above copyright notice and this permission notice shall be included in
+//  all copies or substantial portions of the Software.
+//
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+//  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+//  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+//  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+//  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+//  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+//  THE SOFTWARE.
+//
+
+#import <Foundation/Foundation.h>
+
+NS_ASSUME_NONNULL_BEGIN
+
+typedef NS_ENUM(uint8_t, _SPLRemoteObjectCompressionCodec) {
+    _SPLRemoteObjectCompressionCodecNone = 0,
+    _SPLRemoteObjectCompressionCodecZlib,
+};
+
+/**
+ Compressed frames carry their codec in these bits of the frame header flags.
+ */
+static uint8_t const _SPLRemoteObjectFrameFlagsCompressionCodecMask = 0x03;
+
+/**
+ Frames smaller than this are always sent uncompressed.
+ */
+static NSUInteger const _SPLRemoteObjectCompressionThreshold = 1024;
+
+/**
+ @abstract  Compresses data packages before they are encrypted. The codec is negotiated during the handshake, receivers decompress every codec they offered.
+ */
+@interface _SPLRemoteObjectCompression : NSObject
+
+/**
+ Names of all supported codecs, most preferred first. Offered by clients during the handshake.
+ */
++ (NSArray<NSString *> *)supportedCodecNames;
+
+/**
+ @return The first codec of `codecNames` which is supported, none otherwise.
+ */
++ (_SPLRemoteObjectCompressionCodec)preferredCodecWithNames:(nullable NSArray *)codecNames;
++ (nullable NSString *)nameOfCodec:(_SPLRemoteObjectCompressionCodec)codec;
+
+/**
+ @return Compressed data with the codec stored in `flags`, or `data` with unchanged flags if it is below the threshold or does not shrink.
+ */
++ (NSData *)dataByCompressingData:(NSData *)data codec:(_SPLRemoteObjectCompressionCodec)codec flags:(uint8_t *)flags;
+
+/**
+ @abstract  Returns `data` if `flags` contains no codec. Throws NSInvalidArchiveOperationException for malformed data.
+ */
++ (NSData *)dataByDecompressingData:(NSData *)data flags:(uint8_t)flags;
+
+@end
+
+NS_ASSUME_NONNULL_END
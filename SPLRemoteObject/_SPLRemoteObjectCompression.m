@@ -0,0 +1,167 @@
+//
+//  _SPLRemoteObjectCompression.m
+//  SPLRemoteObject
+//
+//  The MIT License (MIT)
+//  Copyright (c) 2013 Oliver Letterer, Sparrow-Labs
+//
+//  Permission is hereby granted, free of charge, to any person obtaining a copy
+//  of this software and associated documentation files (the "Software"), to deal
+//  in the Software without restriction, including without limitation the rights
+//  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+//  copies of the Software, and to permit persons to whom the Software is
+//  furnished to do so, subject to the following conditions:
+//
+//  The above copyright notice and this permission notice shall be included in
+//  all copies or substantial portions of the Software.
+//
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+//  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+//  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+//  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+//  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+//  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+//  THE SOFTWARE.
+//
+
+#import "_SPLRemoteObjectCompression.h"
+#import <libkern/OSByteOrder.h>
+#import <zlib.h>
+
+// decompressed packages are limited like frames to protect against compression bombs
+static uint32_t const _SPLRemoteObjectCompressionMaximumDecompressedLength = 512 * 1024 * 1024;
+
+// deflate can not expand a stream by more than this, larger claimed lengths are not plausible
+static uint64_t const _SPLRemoteObjectCompressionMaximumRatio = 1032;
+
+// decompressed buffers start with at most this capacity and grow while the stream inflates
+static NSUInteger const _SPLRemoteObjectCompressionInitialCapacity = 64 * 1024;
+
+static void raiseMalformedData(NSString *reason)
+{
+    [NSException raise:NSInvalidArchiveOperationException format:@"malformed compressed data: %@", reason];
+}
+
+
+
+@implementation _SPLRemoteObjectCompression
+
++ (NSArray *)supportedCodecNames
+{
+    return @[ [self nameOfCodec:_SPLRemoteObjectCompressionCodecZlib] ];
+}
+
++ (_SPLRemoteObjectCompressionCodec)preferredCodecWithNames:(NSArray *)codecNames
+{
+    for (id codecName in codecNames) {
+        if ([codecName isEqual:[self nameOfCodec:_SPLRemoteObjectCompressionCodecZlib]]) {
+            return _SPLRemoteObjectCompressionCodecZlib;
+        }
+    }
+
+    return _SPLRemoteObjectCompressionCodecNone;
+}
+
++ (NSString *)nameOfCodec:(_SPLRemoteObjectCompressionCodec)codec
+{
+    switch (codec) {
+        case _SPLRemoteObjectCompressionCodecNone:
+            return nil;
+        case _SPLRemoteObjectCompressionCodecZlib:
+            return @"zlib";
+    }
+
+    return nil;
+}
+
++ (NSData *)dataByCompressingData:(NSData *)data codec:(_SPLRemoteObjectCompressionCodec)codec flags:(uint8_t *)flags
+{
+    NSParameterAssert(flags);
+
+    if (codec != _SPLRemoteObjectCompressionCodecZlib || data.length < _SPLRemoteObjectCompressionThreshold || data.length > _SPLRemoteObjectCompressionMaximumDecompressedLength) {
+        return data;
+    }
+
+    // decompressed length, followed by the zlib stream
+    uLongf compressedLength = compressBound((uLong)data.length);
+    NSMutableData *compressedData = [NSMutableData dataWithLength:sizeof(uint32_t) + compressedLength];
+
+    uint32_t length = OSSwapHostToLittleInt32((uint32_t)data.length);
+    memcpy(compressedData.mutableBytes, &length, sizeof(length));
+
+    // favor speed, payloads are compressed on every request
+    if (compress2((Bytef *)compressedData.mutableBytes + sizeof(uint32_t), &compressedLength, data.bytes, (uLong)data.length, Z_BEST_SPEED) != Z_OK) {
+        return data;
+    }
+
+    compressedData.length = sizeof(uint32_t) + compressedLength;
+    if (compressedData.length >= data.length) {
+        return data;
+    }
+
+    *flags = (*flags & ~_SPLRemoteObjectFrameFlagsCompressionCodecMask) | codec;
+    return compressedData;
+}
+
++ (NSData *)dataByDecompressingData:(NSData *)data flags:(uint8_t)flags
+{
+    _SPLRemoteObjectCompressionCodec codec = flags & _SPLRemoteObjectFrameFlagsCompressionCodecMask;
+
+    if (codec == _SPLRemoteObjectCompressionCodecNone) {
+        return data;
+    } else if (codec != _SPLRemoteObjectCompressionCodecZlib) {
+        raiseMalformedData([NSString stringWithFormat:@"unsupported codec %d", codec]);
+    }
+
+    if (data.length < sizeof(uint32_t)) {
+        raiseMalformedData(@"missing length");
+    }
+
+    uint32_t length = 0;
+    memcpy(&length, data.bytes, sizeof(length));
+    length = OSSwapLittleToHostInt32(length);
+
+    uint64_t compressedLength = data.length - sizeof(uint32_t);
+    if (length > _SPLRemoteObjectCompressionMaximumDecompressedLength || length > compressedLength * _SPLRemoteObjectCompressionMaximumRatio) {
+        raiseMalformedData(@"implausible decompressed length");
+    }
+
+    // memory is only allocated for bytes the stream actually inflates to, one spare byte detects streams longer than claimed
+    NSUInteger maximumCapacity = (NSUInteger)length + 1;
+    NSMutableData *decompressedData = [NSMutableData dataWithLength:MIN(maximumCapacity, _SPLRemoteObjectCompressionInitialCapacity)];
+
+    z_stream stream;
+    memset(&stream, 0, sizeof(stream));
+    stream.next_in = (Bytef *)data.bytes + sizeof(uint32_t);
+    stream.avail_in = (uInt)compressedLength;
+
+    if (inflateInit(&stream) != Z_OK) {
+        raiseMalformedData(@"invalid zlib stream");
+    }
+
+    int status = Z_OK;
+    while (status == Z_OK) {
+        if (stream.total_out == decompressedData.length) {
+            if (decompressedData.length == maximumCapacity) {
+                break;
+            }
+            decompressedData.length = MIN(maximumCapacity, decompressedData.length * 2);
+        }
+
+        stream.next_out = (Bytef *)decompressedData.mutableBytes + stream.total_out;
+        stream.avail_out = (uInt)(decompressedData.length - stream.total_out);
+        status = inflate(&stream, Z_NO_FLUSH);
+    }
+
+    uLong decompressedLength = stream.total_out;
+    inflateEnd(&stream);
+
+    if (status != Z_STREAM_END || decompressedLength != length) {
+        raiseMalformedData(@"invalid zlib stream");
+    }
+
+    decompressedData.length = length;
+    return decompressedData;
+}
+
+@end
@@ -25,17 +25,53 @@
 //
 
 #import <Foundation/Foundation.h>
+#import "_SPLRemoteObjectEventLoop.h"
 
 @class _SPLRemoteObjectConnection;
 
 NS_ASSUME_NONNULL_BEGIN
 
+/**
+ Sent with every handshake, bumped whenever the frame layout or the handshake changes.
+ */
+static NSInteger const _SPLRemoteObjectHandshakeVersion = 7;
+
+typedef NS_ENUM(uint8_t, _SPLRemoteObjectFrameType) {
+    _SPLRemoteObjectFrameTypeInvocation = 0, // requests and their responses
+    _SPLRemoteObjectFrameTypeHandshake, // first frame in both directions of every connection
+    _SPLRemoteObjectFrameTypeAttachment, // raw data following the frame it belongs to
+    _SPLRemoteObjectFrameTypeStreamItem, // one result of a streaming method, the invocation response ends the stream
+    _SPLRemoteObjectFrameTypeBatch, // array of requests answered by one invocation response with an array of results
+    _SPLRemoteObjectFrameTypeSubscription, // all event names a client is subscribed to, replaces the previous subscription
+    _SPLRemoteObjectFrameTypeEvent, // event name and event pushed by the proxy to subscribed clients
+    _SPLRemoteObjectFrameTypeCancel, // empty, cancels the request with the same identifier
+};
+
+/**
+ Every data package is prefixed with this header. `identifier` matches a response to its request so that many requests can be in flight on the same connection. A frame with attachments is immediately followed by `numberOfAttachments` attachment frames.
+ */
+typedef struct {
+    uint32_t length;
+    uint32_t identifier;
+    _SPLRemoteObjectFrameType type;
+    uint8_t flags;
+    uint16_t numberOfAttachments;
+} _SPLRemoteObjectFrameHeader;
+
+/**
+ Requests with a deadline are prefixed with the milliseconds their client still waits for the response, as uint32_t in network byte order. The budget is relative because clocks of client and proxy are not synchronized, and it is not encrypted so that expired requests are dropped before they are decrypted.
+ */
+static uint8_t const _SPLRemoteObjectFrameFlagsDeadline = 0x04;
+
 @protocol _SPLRemoteObjectConnectionDelegate <NSObject>
 
 - (void)remoteObjectConnectionConnectionAttemptFailed:(_SPLRemoteObjectConnection *)connection;
 - (void)remoteObjectConnectionConnectionEnded:(_SPLRemoteObjectConnection *)connection;
 
-- (void)remoteObjectConnection:(_SPLRemoteObjectConnection *)connection didReceiveDataPackage:(NSData *)dataPackage;
+/**
+ @param attachments Bodies of the attachment frames which followed this frame, each in its own buffer.
+ */
+- (void)remoteObjectConnection:(_SPLRemoteObjectConnection *)connection didReceiveDataPackage:(NSData *)dataPackage attachments:(NSArray<NSData *> *)attachments header:(_SPLRemoteObjectFrameHeader)header;
 
 @end
 
@@ -51,14 +87,56 @@ NS_ASSUME_NONNULL_BEGIN
 
 @property (nonatomic, readonly) BOOL isClientConnection;
 
+/**
+ Streams, timers and delegate callbacks of this connection are scheduled on this event loop. Must be set before connecting, defaults to the main event loop.
+ */
+@property (nonatomic, strong) _SPLRemoteObjectEventLoop *eventLoop;
+
 @property (nonatomic, weak) id<_SPLRemoteObjectConnectionDelegate> delegate;
 
 @property (nonatomic, readonly) BOOL isConnected;
 
+/**
+ Connection attempts which did not open both streams in this interval fail, defaults to 10 seconds.
+ */
+@property (nonatomic, assign) NSTimeInterval connectTimeoutInterval;
+
+/**
+ Bytes of all frames queued on and written to this connection since it was created. A frame has been written completely once `numberOfWrittenBytes` reached `numberOfQueuedBytes` as it was right after queueing the frame. Only accessed on `eventLoop`.
+ */
+@property (nonatomic, readonly) uint64_t numberOfQueuedBytes;
+@property (nonatomic, readonly) uint64_t numberOfWrittenBytes;
+
+/**
+ @return    The prefix which carries the remaining `budget` of a deadline in front of a data package, sets `_SPLRemoteObjectFrameFlagsDeadline` in `flags`.
+ */
++ (NSData *)deadlinePrefixWithBudget:(NSTimeInterval)budget flags:(uint8_t *)flags;
+
+/**
+ @return    `dataPackage` without its deadline prefix. `budget` is the remaining budget, or negative if `flags` has no deadline.
+ */
++ (NSData *)dataPackageByRemovingDeadlineBudget:(NSTimeInterval *)budget fromData:(NSData *)dataPackage flags:(uint8_t)flags;
+
 - (void)connect;
 - (void)disconnect;
 
-- (void)sendDataPackage:(NSData *)dataPackage;
+/**
+ @abstract  Disconnects once every queued frame has been written, which keeps frames that are never answered from being dropped. The connection stays alive until then, `completionHandler` is called once it disconnected.
+ */
+- (void)disconnectAfterSendingQueuedDataWithCompletionHandler:(nullable dispatch_block_t)completionHandler;
+
+/**
+ @abstract  Can be called from any thread, the data package is sent from `eventLoop`.
+ */
+- (void)sendDataPackage:(NSData *)dataPackage identifier:(uint32_t)identifier;
+- (void)sendDataPackage:(NSData *)dataPackage attachments:(nullable NSArray<NSData *> *)attachments identifier:(uint32_t)identifier;
+- (void)sendDataPackage:(NSData *)dataPackage identifier:(uint32_t)identifier type:(_SPLRemoteObjectFrameType)type flags:(uint8_t)flags;
+- (void)sendDataPackage:(NSData *)dataPackage attachments:(nullable NSArray<NSData *> *)attachments identifier:(uint32_t)identifier type:(_SPLRemoteObjectFrameType)type flags:(uint8_t)flags;
+
+/**
+ @abstract  `prefix` is written in front of `dataPackage` within the same frame, from its own buffer.
+ */
+- (void)sendDataPackage:(NSData *)dataPackage prefix:(nullable NSData *)prefix attachments:(nullable NSArray<NSData *> *)attachments identifier:(uint32_t)identifier type:(_SPLRemoteObjectFrameType)type flags:(uint8_t)flags;
 
 @end
 
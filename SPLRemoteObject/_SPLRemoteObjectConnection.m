@@ -28,6 +28,22 @@
 #import "SPLRemoteObject.h"
 #import <Security/Security.h>
 #import <Security/SecureTransport.h>
+#include <sys/uio.h>
+#include <fcntl.h>
+#include <errno.h>
+
+static size_t const _SPLRemoteObjectConnectionMinimumReadBufferCapacity = 4 * 1024;
+static size_t const _SPLRemoteObjectConnectionMaximumReadBufferCapacity = 1024 * 1024;
+
+// frame bodies of at least this size are read straight from the stream into their own buffer
+static size_t const _SPLRemoteObjectConnectionDirectReadThreshold = 16 * 1024;
+
+static uint32_t const _SPLRemoteObjectConnectionMaximumFrameLength = 512 * 1024 * 1024;
+
+// frame bodies start with at most this capacity and grow as their bytes arrive, a header alone never allocates the announced length
+static size_t const _SPLRemoteObjectConnectionInitialPacketBodyCapacity = 64 * 1024;
+
+static int const _SPLRemoteObjectConnectionMaximumNumberOfWriteSegments = 64;
 
 static BOOL streamIsHealthyAndOpen(NSStream *stream)
 {
@@ -42,10 +58,35 @@ static BOOL streamIsHealthyAndOpen(NSStream *stream)
 
 
 @interface _SPLRemoteObjectConnection () <NSStreamDelegate> {
-    NSMutableData *_incomingDataBuffer;
-    NSMutableData *_outgoingDataBuffer;
-
-    int32_t _packetBodySize;
+    // queued frame headers and payloads, the first _outgoingSegmentOffset bytes of the first segment have already been written
+    NSMutableArray *_outgoingSegments;
+    size_t _outgoingSegmentOffset;
+
+    // set by -disconnectAfterSendingQueuedDataWithCompletionHandler:, retains self until the connection disconnected
+    BOOL _disconnectsAfterSendingQueuedData;
+    dispatch_block_t _disconnectCompletionHandler;
+
+    CFSocketNativeHandle _outputSocketHandle;
+    dispatch_source_t _outputSocketWriteSource;
+    BOOL _isOutputSocketWriteSourceSuspended;
+
+    // bytes in [_readBufferOffset, _readBufferLength) have been read from the stream but are not consumed yet
+    uint8_t *_readBuffer;
+    size_t _readBufferCapacity;
+    size_t _readBufferOffset;
+    size_t _readBufferLength;
+
+    // every frame body is received into its own buffer which is handed to the delegate without copying
+    _SPLRemoteObjectFrameHeader _packetHeader;
+    uint8_t *_packetBody;
+    size_t _packetBodyCapacity;
+    size_t _packetBodyOffset;
+    BOOL _isReceivingPacketBody;
+
+    // a received frame waits here until all of its attachment frames arrived
+    _SPLRemoteObjectFrameHeader _attachedPacketHeader;
+    NSData *_attachedDataPackage;
+    NSMutableArray *_receivedAttachments;
 }
 
 @property (nonatomic, readonly) BOOL isInputStreamOpen;
@@ -68,14 +109,13 @@ static BOOL streamIsHealthyAndOpen(NSStream *stream)
 - (void)setInputStream:(NSInputStream *)inputStream
 {
     if (inputStream != _inputStream) {
-        _inputStream.delegate = nil;
+        [self _detachStream:_inputStream];
         [_inputStream close];
-        [_inputStream removeFromRunLoop:[NSRunLoop mainRunLoop] forMode:NSRunLoopCommonModes];
 
         _inputStream = inputStream;
 
         _inputStream.delegate = self;
-        [_inputStream scheduleInRunLoop:[NSRunLoop mainRunLoop] forMode:NSRunLoopCommonModes];
+        [_inputStream scheduleInRunLoop:_eventLoop.runLoop forMode:NSRunLoopCommonModes];
         [_inputStream open];
     }
 }
@@ -83,27 +123,67 @@ static BOOL streamIsHealthyAndOpen(NSStream *stream)
 - (void)setOutputStream:(NSOutputStream *)outputStream
 {
     if (outputStream != _outputStream) {
-        _outputStream.delegate = nil;
+        [self _detachStream:_outputStream];
         [_outputStream close];
-        [_outputStream removeFromRunLoop:[NSRunLoop mainRunLoop] forMode:NSRunLoopCommonModes];
 
         _outputStream = outputStream;
 
         _outputStream.delegate = self;
-        [_outputStream scheduleInRunLoop:[NSRunLoop mainRunLoop] forMode:NSRunLoopCommonModes];
+        [_outputStream scheduleInRunLoop:_eventLoop.runLoop forMode:NSRunLoopCommonModes];
         [_outputStream open];
     }
 }
 
+#pragma mark - Class methods
+
++ (NSData *)deadlinePrefixWithBudget:(NSTimeInterval)budget flags:(uint8_t *)flags
+{
+    NSParameterAssert(flags);
+
+    uint32_t milliseconds = CFSwapInt32HostToBig((uint32_t)MIN(MAX(budget, 0.0) * 1000.0, (NSTimeInterval)UINT32_MAX));
+
+    *flags |= _SPLRemoteObjectFrameFlagsDeadline;
+    return [NSData dataWithBytes:&milliseconds length:sizeof(milliseconds)];
+}
+
++ (NSData *)dataPackageByRemovingDeadlineBudget:(NSTimeInterval *)budget fromData:(NSData *)dataPackage flags:(uint8_t)flags
+{
+    NSParameterAssert(budget);
+
+    if (!(flags & _SPLRemoteObjectFrameFlagsDeadline)) {
+        *budget = -1.0;
+        return dataPackage;
+    }
+
+    // a truncated prefix is treated as an expired deadline
+    uint32_t milliseconds = 0;
+    if (dataPackage.length < sizeof(milliseconds)) {
+        *budget = 0.0;
+        return [NSData data];
+    }
+
+    [dataPackage getBytes:&milliseconds length:sizeof(milliseconds)];
+    *budget = CFSwapInt32BigToHost(milliseconds) / 1000.0;
+
+    // the remainder points into the received package, which is kept alive until the remainder is released
+    NSData *receivedDataPackage = [dataPackage copy];
+    return [[NSData alloc] initWithBytesNoCopy:(void *)((const uint8_t *)receivedDataPackage.bytes + sizeof(milliseconds)) length:receivedDataPackage.length - sizeof(milliseconds) deallocator:^(void *bytes, NSUInteger length) {
+        (void)receivedDataPackage;
+    }];
+}
+
 #pragma mark - Initialization
 
 - (id)init
 {
     if (self = [super init]) {
-        _incomingDataBuffer = [NSMutableData dataWithCapacity:1024];
-        _outgoingDataBuffer = [NSMutableData dataWithCapacity:1024];
+        _eventLoop = [_SPLRemoteObjectEventLoop mainEventLoop];
+        _connectTimeoutInterval = 10.0;
+        _outgoingSegments = [NSMutableArray array];
+        _outputSocketHandle = -1;
 
-        _packetBodySize = -1;
+        _readBufferCapacity = _SPLRemoteObjectConnectionMinimumReadBufferCapacity;
+        _readBuffer = malloc(_readBufferCapacity);
     }
     return self;
 }
@@ -116,12 +196,13 @@ static BOOL streamIsHealthyAndOpen(NSStream *stream)
 
     [[NSNotificationCenter defaultCenter] postNotificationName:SPLRemoteObjectNetworkOperationDidStartNotification object:nil];
 
-    dispatch_after(dispatch_time(DISPATCH_TIME_NOW, (int64_t)(10.0 * NSEC_PER_SEC)), dispatch_get_main_queue(), ^{
-        if (self.isConnected) {
+    // only the connection attempt times out here, established connections may stay open and be reused
+    [_eventLoop performBlock:^{
+        if (self.isConnected && (!self.isInputStreamOpen || !self.isOutputStreamOpen)) {
             [self disconnect];
             [self.delegate remoteObjectConnectionConnectionAttemptFailed:self];
         }
-    });
+    } afterDelay:_connectTimeoutInterval];
 }
 
 - (void)disconnect
@@ -134,19 +215,156 @@ static BOOL streamIsHealthyAndOpen(NSStream *stream)
 
     [[NSNotificationCenter defaultCenter] postNotificationName:SPLRemoteObjectNetworkOperationDidEndNotification object:nil];
 
-    self.inputStream = nil;
-    self.outputStream = nil;
+    // the streams own the socket, its descriptor must stay open until the write source stopped watching it
+    dispatch_source_t writeSource = _outputSocketWriteSource;
+    _outputSocketWriteSource = nil;
+    _outputSocketHandle = -1;
+
+    if (writeSource) {
+        NSInputStream *inputStream = _inputStream;
+        NSOutputStream *outputStream = _outputStream;
+        _SPLRemoteObjectEventLoop *eventLoop = _eventLoop;
+
+        [self _detachStream:_inputStream];
+        [self _detachStream:_outputStream];
+        _inputStream = nil;
+        _outputStream = nil;
+
+        dispatch_source_set_cancel_handler(writeSource, ^{
+            [eventLoop performBlock:^{
+                [inputStream close];
+                [outputStream close];
+            }];
+        });
+
+        // a source suspended by its event handler is resumed by _outputSocketDidBecomeWritable:, its cancel handler runs after that
+        if (_isOutputSocketWriteSourceSuspended) {
+            _isOutputSocketWriteSourceSuspended = NO;
+            dispatch_resume(writeSource);
+        }
+        dispatch_source_cancel(writeSource);
+    } else {
+        self.inputStream = nil;
+        self.outputStream = nil;
+    }
+
+    _readBufferOffset = 0;
+    _readBufferLength = 0;
+
+    free(_packetBody), _packetBody = NULL;
+    _packetBodyCapacity = 0;
+    _packetBodyOffset = 0;
+    _isReceivingPacketBody = NO;
+
+    _attachedDataPackage = nil;
+    _receivedAttachments = nil;
+
+    [_outgoingSegments removeAllObjects];
+    _outgoingSegmentOffset = 0;
+
+    dispatch_block_t disconnectCompletionHandler = _disconnectCompletionHandler;
+    _disconnectsAfterSendingQueuedData = NO;
+    _disconnectCompletionHandler = nil;
+
+    if (disconnectCompletionHandler) {
+        disconnectCompletionHandler();
+    }
+}
+
+- (void)disconnectAfterSendingQueuedDataWithCompletionHandler:(dispatch_block_t)completionHandler
+{
+    if (!_eventLoop.isCurrentEventLoop) {
+        [_eventLoop performBlock:^{
+            [self disconnectAfterSendingQueuedDataWithCompletionHandler:completionHandler];
+        }];
+        return;
+    }
+
+    if (!_isConnected || _outgoingSegments.count == 0) {
+        [self disconnect];
+
+        if (completionHandler) {
+            completionHandler();
+        }
+        return;
+    }
+
+    // the completion handler captures self, which keeps this connection alive until the remaining frames are written
+    __block _SPLRemoteObjectConnection *connection = self;
+    _disconnectsAfterSendingQueuedData = YES;
+    _disconnectCompletionHandler = ^{
+        connection = nil;
+
+        if (completionHandler) {
+            completionHandler();
+        }
+    };
+}
 
-    [_incomingDataBuffer replaceBytesInRange:NSMakeRange(0, _incomingDataBuffer.length) withBytes:NULL length:0];
-    [_outgoingDataBuffer replaceBytesInRange:NSMakeRange(0, _outgoingDataBuffer.length) withBytes:NULL length:0];
+- (void)sendDataPackage:(NSData *)dataPackage identifier:(uint32_t)identifier
+{
+    [self sendDataPackage:dataPackage attachments:nil identifier:identifier type:_SPLRemoteObjectFrameTypeInvocation flags:0];
+}
+
+- (void)sendDataPackage:(NSData *)dataPackage attachments:(NSArray *)attachments identifier:(uint32_t)identifier
+{
+    [self sendDataPackage:dataPackage attachments:attachments identifier:identifier type:_SPLRemoteObjectFrameTypeInvocation flags:0];
+}
+
+- (void)sendDataPackage:(NSData *)dataPackage identifier:(uint32_t)identifier type:(_SPLRemoteObjectFrameType)type flags:(uint8_t)flags
+{
+    [self sendDataPackage:dataPackage attachments:nil identifier:identifier type:type flags:flags];
 }
 
-- (void)sendDataPackage:(NSData *)dataPackage
+- (void)sendDataPackage:(NSData *)dataPackage attachments:(NSArray *)attachments identifier:(uint32_t)identifier type:(_SPLRemoteObjectFrameType)type flags:(uint8_t)flags
 {
-    int32_t length = (int32_t)dataPackage.length;
+    [self sendDataPackage:dataPackage prefix:nil attachments:attachments identifier:identifier type:type flags:flags];
+}
+
+- (void)sendDataPackage:(NSData *)dataPackage prefix:(NSData *)prefix attachments:(NSArray *)attachments identifier:(uint32_t)identifier type:(_SPLRemoteObjectFrameType)type flags:(uint8_t)flags
+{
+    NSParameterAssert(attachments.count <= UINT16_MAX);
+
+    if (!_eventLoop.isCurrentEventLoop) {
+        [_eventLoop performBlock:^{
+            [self sendDataPackage:dataPackage prefix:prefix attachments:attachments identifier:identifier type:type flags:flags];
+        }];
+        return;
+    }
+
+    _SPLRemoteObjectFrameHeader header = {
+        .length = (uint32_t)(prefix.length + dataPackage.length),
+        .identifier = identifier,
+        .type = type,
+        .flags = flags,
+        .numberOfAttachments = (uint16_t)attachments.count,
+    };
+
+    _numberOfQueuedBytes += sizeof(header) + prefix.length + dataPackage.length;
+
+    [_outgoingSegments addObject:[NSData dataWithBytes:&header length:sizeof(header)]];
+    if (prefix.length > 0) {
+        [_outgoingSegments addObject:[prefix copy]];
+    }
+    if (dataPackage.length > 0) {
+        [_outgoingSegments addObject:[dataPackage copy]];
+    }
+
+    // attachments are written from their own buffers with writev, they are never copied into a frame
+    for (NSData *attachment in attachments) {
+        _SPLRemoteObjectFrameHeader attachmentHeader = {
+            .length = (uint32_t)attachment.length,
+            .identifier = identifier,
+            .type = _SPLRemoteObjectFrameTypeAttachment,
+        };
+
+        _numberOfQueuedBytes += sizeof(attachmentHeader) + attachment.length;
 
-    [_outgoingDataBuffer appendBytes:&length length:sizeof(int32_t)];
-    [_outgoingDataBuffer appendData:dataPackage];
+        [_outgoingSegments addObject:[NSData dataWithBytes:&attachmentHeader length:sizeof(attachmentHeader)]];
+        if (attachment.length > 0) {
+            [_outgoingSegments addObject:[attachment copy]];
+        }
+    }
 
     [self _sendNextChunkOfData];
 }
@@ -156,6 +374,9 @@ static BOOL streamIsHealthyAndOpen(NSStream *stream)
 - (void)dealloc
 {
     [self disconnect];
+
+    free(_packetBody);
+    free(_readBuffer);
 }
 
 #pragma mark - NSStreamDelegate
@@ -173,38 +394,151 @@ static BOOL streamIsHealthyAndOpen(NSStream *stream)
 
 - (void)_readNextChunkOfData
 {
-    uint8_t buffer[1024];
+    while (_isConnected) {
+        size_t availableLength = _readBufferLength - _readBufferOffset;
 
-    size_t processed = 0;
-    do {
-        processed = [self _readDataFromReadStream:buffer length:sizeof(buffer)];
-        [_incomingDataBuffer appendBytes:buffer length:processed];
-    } while (processed > 0);
+        if (!_isReceivingPacketBody) {
+            if (availableLength < sizeof(_SPLRemoteObjectFrameHeader)) {
+                if ([self _fillReadBuffer] == 0) {
+                    break;
+                }
 
-    while(YES) {
-        if (_packetBodySize == -1) {
-            if (_incomingDataBuffer.length >= sizeof(int32_t)) {
-                memcpy(&_packetBodySize, _incomingDataBuffer.bytes, sizeof(int32_t));
+                continue;
+            }
 
-                NSRange rangeToDelete = NSMakeRange(0, sizeof(int32_t));
-                [_incomingDataBuffer replaceBytesInRange:rangeToDelete withBytes:NULL length:0];
-            } else {
+            memcpy(&_packetHeader, _readBuffer + _readBufferOffset, sizeof(_SPLRemoteObjectFrameHeader));
+            _readBufferOffset += sizeof(_SPLRemoteObjectFrameHeader);
+
+            if (_packetHeader.length > _SPLRemoteObjectConnectionMaximumFrameLength) {
+                NSLog(@"[%@] frame of %u bytes exceeds maximum frame length => disconnecting", NSStringFromSelector(_cmd), _packetHeader.length);
+
+                [self disconnect];
+                [_delegate remoteObjectConnectionConnectionEnded:self];
                 break;
             }
+
+            _packetBodyCapacity = MIN((size_t)_packetHeader.length, _SPLRemoteObjectConnectionInitialPacketBodyCapacity);
+            _packetBody = _packetBodyCapacity > 0 ? malloc(_packetBodyCapacity) : NULL;
+            _packetBodyOffset = 0;
+            _isReceivingPacketBody = YES;
+
+            continue;
         }
 
-        if (_incomingDataBuffer.length >= _packetBodySize) {
-            NSData *dataPackage = [_incomingDataBuffer subdataWithRange:NSMakeRange(0, _packetBodySize)];
-            [_delegate remoteObjectConnection:self didReceiveDataPackage:dataPackage];
+        size_t remainingLength = _packetHeader.length - _packetBodyOffset;
+
+        if (remainingLength > 0) {
+            if (availableLength > 0) {
+                size_t length = MIN(availableLength, remainingLength);
+                [self _growPacketBodyToCapacity:_packetBodyOffset + length];
+                memcpy(_packetBody + _packetBodyOffset, _readBuffer + _readBufferOffset, length);
+
+                _readBufferOffset += length;
+                _packetBodyOffset += length;
+            } else if (remainingLength >= _SPLRemoteObjectConnectionDirectReadThreshold) {
+                if (_packetBodyOffset == _packetBodyCapacity) {
+                    [self _growPacketBodyToCapacity:_packetBodyCapacity + 1];
+                }
+
+                size_t length = [self _readDataFromReadStream:_packetBody + _packetBodyOffset length:MIN(remainingLength, _packetBodyCapacity - _packetBodyOffset)];
+                if (length == 0) {
+                    break;
+                }
+
+                _packetBodyOffset += length;
+            } else if ([self _fillReadBuffer] == 0) {
+                break;
+            }
 
-            NSRange rangeToDelete = NSMakeRange(0, MIN(_packetBodySize, _incomingDataBuffer.length));
-            [_incomingDataBuffer replaceBytesInRange:rangeToDelete withBytes:NULL length:0];
+            continue;
+        }
 
-            _packetBodySize = -1;
+        NSData *dataPackage = nil;
+        if (_packetBody) {
+            dataPackage = [NSData dataWithBytesNoCopy:_packetBody length:_packetHeader.length freeWhenDone:YES];
         } else {
-            break;
+            dataPackage = [NSData data];
+        }
+
+        _packetBody = NULL;
+        _packetBodyCapacity = 0;
+        _packetBodyOffset = 0;
+        _isReceivingPacketBody = NO;
+
+        if (_receivedAttachments || _packetHeader.type == _SPLRemoteObjectFrameTypeAttachment) {
+            if (!_receivedAttachments || _packetHeader.type != _SPLRemoteObjectFrameTypeAttachment || _packetHeader.identifier != _attachedPacketHeader.identifier) {
+                NSLog(@"[%@] unexpected frame while receiving attachments => disconnecting", NSStringFromSelector(_cmd));
+
+                [self disconnect];
+                [_delegate remoteObjectConnectionConnectionEnded:self];
+                break;
+            }
+
+            [_receivedAttachments addObject:dataPackage];
+            if (_receivedAttachments.count < _attachedPacketHeader.numberOfAttachments) {
+                continue;
+            }
+
+            NSData *attachedDataPackage = _attachedDataPackage;
+            NSArray *attachments = _receivedAttachments;
+            _attachedDataPackage = nil;
+            _receivedAttachments = nil;
+
+            [_delegate remoteObjectConnection:self didReceiveDataPackage:attachedDataPackage attachments:attachments header:_attachedPacketHeader];
+            continue;
+        }
+
+        if (_packetHeader.numberOfAttachments > 0) {
+            _attachedPacketHeader = _packetHeader;
+            _attachedDataPackage = dataPackage;
+            _receivedAttachments = [NSMutableArray arrayWithCapacity:_packetHeader.numberOfAttachments];
+            continue;
         }
+
+        [_delegate remoteObjectConnection:self didReceiveDataPackage:dataPackage attachments:@[] header:_packetHeader];
+    }
+}
+
+/**
+ Doubles the capacity of the current frame body until it holds `capacity` bytes, never beyond the length of the frame.
+ */
+- (void)_growPacketBodyToCapacity:(size_t)capacity
+{
+    if (capacity <= _packetBodyCapacity) {
+        return;
+    }
+
+    size_t newCapacity = MAX(_packetBodyCapacity, 1);
+    while (newCapacity < capacity) {
+        newCapacity *= 2;
+    }
+
+    _packetBodyCapacity = MIN(newCapacity, (size_t)_packetHeader.length);
+    _packetBody = reallocf(_packetBody, _packetBodyCapacity);
+}
+
+- (size_t)_fillReadBuffer
+{
+    size_t availableLength = _readBufferLength - _readBufferOffset;
+
+    // only a partial frame header can be left over at this point, so moving it to the front is cheap
+    if (_readBufferOffset > 0) {
+        memmove(_readBuffer, _readBuffer + _readBufferOffset, availableLength);
+
+        _readBufferOffset = 0;
+        _readBufferLength = availableLength;
     }
+
+    size_t length = [self _readDataFromReadStream:_readBuffer + _readBufferLength length:_readBufferCapacity - _readBufferLength];
+    _readBufferLength += length;
+
+    // grow chunk size while the stream keeps filling the whole buffer
+    if (_readBufferLength == _readBufferCapacity && _readBufferCapacity < _SPLRemoteObjectConnectionMaximumReadBufferCapacity) {
+        _readBufferCapacity *= 2;
+        _readBuffer = reallocf(_readBuffer, _readBufferCapacity);
+    }
+
+    return length;
 }
 
 - (void)_inputStreamHandleEventType:(NSStreamEvent)eventType
@@ -229,20 +563,140 @@ static BOOL streamIsHealthyAndOpen(NSStream *stream)
 
 - (void)_sendNextChunkOfData
 {
-    if (_outgoingDataBuffer.length == 0) {
+    while (_outgoingSegments.count > 0) {
+        size_t processed = 0;
+
+        if (_outputSocketHandle >= 0) {
+            processed = [self _writeOutgoingSegmentsToSocket];
+        } else {
+            NSData *segment = _outgoingSegments.firstObject;
+            processed = [self _writeDataToWriteStream:(const uint8_t *)segment.bytes + _outgoingSegmentOffset length:segment.length - _outgoingSegmentOffset];
+        }
+
+        if (processed == 0) {
+            break;
+        }
+
+        _numberOfWrittenBytes += processed;
+
+        while (processed > 0 && _outgoingSegments.count > 0) {
+            NSData *segment = _outgoingSegments.firstObject;
+            size_t remainingLength = segment.length - _outgoingSegmentOffset;
+
+            if (processed >= remainingLength) {
+                processed -= remainingLength;
+
+                [_outgoingSegments removeObjectAtIndex:0];
+                _outgoingSegmentOffset = 0;
+            } else {
+                _outgoingSegmentOffset += processed;
+                processed = 0;
+            }
+        }
+    }
+
+    if (_disconnectsAfterSendingQueuedData && _outgoingSegments.count == 0) {
+        [self disconnect];
+    }
+}
+
+- (size_t)_writeOutgoingSegmentsToSocket
+{
+    struct iovec vectors[_SPLRemoteObjectConnectionMaximumNumberOfWriteSegments];
+    int numberOfVectors = 0;
+
+    for (NSData *segment in _outgoingSegments) {
+        if (numberOfVectors == _SPLRemoteObjectConnectionMaximumNumberOfWriteSegments) {
+            break;
+        }
+
+        size_t offset = numberOfVectors == 0 ? _outgoingSegmentOffset : 0;
+        vectors[numberOfVectors].iov_base = (uint8_t *)segment.bytes + offset;
+        vectors[numberOfVectors].iov_len = segment.length - offset;
+        numberOfVectors++;
+    }
+
+    ssize_t writtenBytes = writev(_outputSocketHandle, vectors, numberOfVectors);
+
+    if (writtenBytes < 0) {
+        if (errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR) {
+            [self _waitUntilOutputSocketIsWritable];
+        } else {
+            [self disconnect];
+            [_delegate remoteObjectConnectionConnectionEnded:self];
+        }
+
+        return 0;
+    }
+
+    return writtenBytes;
+}
+
+- (void)_detachStream:(NSStream *)stream
+{
+    stream.delegate = nil;
+    [stream removeFromRunLoop:_eventLoop.runLoop forMode:NSRunLoopCommonModes];
+}
+
+- (void)_waitUntilOutputSocketIsWritable
+{
+    if (!_outputSocketWriteSource) {
+        _outputSocketWriteSource = dispatch_source_create(DISPATCH_SOURCE_TYPE_WRITE, _outputSocketHandle, 0, dispatch_get_global_queue(DISPATCH_QUEUE_PRIORITY_DEFAULT, 0));
+        _isOutputSocketWriteSourceSuspended = YES;
+
+        __weak typeof(self) weakSelf = self;
+        _SPLRemoteObjectEventLoop *eventLoop = _eventLoop;
+        dispatch_source_t writeSource = _outputSocketWriteSource;
+        dispatch_source_set_event_handler(_outputSocketWriteSource, ^{
+            // fires until the socket has been written to => stop listening until the event loop picked it up
+            dispatch_suspend(writeSource);
+
+            [eventLoop performBlock:^{
+                __strong typeof(weakSelf) strongSelf = weakSelf;
+
+                if (strongSelf) {
+                    [strongSelf _outputSocketDidBecomeWritable:writeSource];
+                } else {
+                    // a suspended source must not be released
+                    dispatch_resume(writeSource);
+                }
+            }];
+        });
+    }
+
+    if (_isOutputSocketWriteSourceSuspended) {
+        _isOutputSocketWriteSourceSuspended = NO;
+        dispatch_resume(_outputSocketWriteSource);
+    }
+}
+
+- (void)_outputSocketDidBecomeWritable:(dispatch_source_t)writeSource
+{
+    if (writeSource != _outputSocketWriteSource) {
+        // connection has been disconnected in the meantime
+        dispatch_resume(writeSource);
         return;
     }
 
-    size_t processed = processed = [self _writeDataToWriteStream:_outgoingDataBuffer.bytes length:_outgoingDataBuffer.length];
-    
-    NSRange range = NSMakeRange(0, processed);
-    [_outgoingDataBuffer replaceBytesInRange:range withBytes:NULL length:0];
+    _isOutputSocketWriteSourceSuspended = YES;
+    [self _sendNextChunkOfData];
 }
 
 - (void)_outputStreamHandleEventType:(NSStreamEvent)eventType
 {
     if (eventType == NSStreamEventOpenCompleted) {
         _isOutputStreamOpen = YES;
+
+        // queued frames are flushed with a single scatter/gather write straight to the socket whenever possible
+        CFDataRef socketHandleData = CFWriteStreamCopyProperty((__bridge CFWriteStreamRef)self.outputStream, kCFStreamPropertySocketNativeHandle);
+        if (socketHandleData) {
+            CFDataGetBytes(socketHandleData, CFRangeMake(0, sizeof(CFSocketNativeHandle)), (UInt8 *)&_outputSocketHandle);
+            CFRelease(socketHandleData);
+
+            fcntl(_outputSocketHandle, F_SETFL, fcntl(_outputSocketHandle, F_GETFL, 0) | O_NONBLOCK);
+        }
+
+        [self _sendNextChunkOfData];
     } else if (eventType == NSStreamEventHasSpaceAvailable) {
         [self _sendNextChunkOfData];
     } else if (eventType == NSStreamEventEndEncountered || eventType == NSStreamEventErrorOccurred) {
@@ -266,7 +720,7 @@ static BOOL streamIsHealthyAndOpen(NSStream *stream)
 
     NSInteger bytesRead = [self.inputStream read:data maxLength:length];
 
-    if (length <= 0 || !streamIsHealthyAndOpen(self.inputStream)) {
+    if (bytesRead <= 0 || !streamIsHealthyAndOpen(self.inputStream)) {
         [self disconnect];
         [_delegate remoteObjectConnectionConnectionEnded:self];
         return 0;
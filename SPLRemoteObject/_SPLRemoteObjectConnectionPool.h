@@ -0,0 +1,77 @@
+//
+//  _SPLRemoteObjectConnectionPool.h
+//  SPLRemoteObject
+//
+//  The MIT License (MIT)
+//  Copyright (c) 2013 Oliver Letterer, Sparrow-Labs
+//
+//  Permission is hereby granted, free of charge, to any person obtaining a copy
+//  of this software and associated documentation files (the "Software"), to deal
+//  in the Software without restriction, including without limitation the rights
+//  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+//  copies of the Software, and to permit persons to whom the Software is
+//  furnished to do so, subject to the following conditions:
+//
+//  The above copyright notice and this permission notice shall be included in
+//  all copies or substantial portions of the Software.
+//
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+//  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+//  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+//  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+//  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+//  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+//  THE SOFTWARE.
+//
+
+#import "_SPLRemoteObjectHostConnection.h"
+
+NS_ASSUME_NONNULL_BEGIN
+
+/**
+ @abstract  Keeps warm connections to a remote host. Invocations are multiplexed over the pooled connections, connections without pending invocations are disconnected after `idleTimeoutInterval`. Not thread safe, every method must be called on `eventLoop`.
+ */
+@interface _SPLRemoteObjectConnectionPool : NSObject
+
+/**
+ Surplus connections with pending invocations leave the pool but are kept until they become idle.
+ */
+@property (nonatomic, assign) NSUInteger maximumNumberOfConnections;
+@property (nonatomic, assign) NSTimeInterval idleTimeoutInterval;
+
+@property (nonatomic, readonly) NSArray *connections;
+
+/**
+ Idle connections are evicted on this event loop, defaults to the main event loop.
+ */
+@property (nonatomic, strong) _SPLRemoteObjectEventLoop *eventLoop;
+
+/**
+ @return The least busy pooled connection to `host`. Returns nil if the pool can hold another connection and no idle connection is available, in which case the caller should open a new connection and add it to the pool.
+ */
+- (nullable _SPLRemoteObjectHostConnection *)connectionToHost:(NSString *)host port:(NSInteger)port;
+
+/**
+ @return NO if the pool is full. The caller is responsible for disconnecting `connection` once it becomes idle in that case.
+ */
+- (BOOL)addConnection:(_SPLRemoteObjectHostConnection *)connection;
+- (void)removeConnection:(_SPLRemoteObjectHostConnection *)connection;
+
+/**
+ @return YES for pooled connections and for connections which left the pool while they had pending invocations.
+ */
+- (BOOL)containsConnection:(_SPLRemoteObjectHostConnection *)connection;
+
+/**
+ @abstract  Schedules `connection` for eviction if it is still idle after `idleTimeoutInterval`. Connections which already left the pool are disconnected once their queued data is sent.
+ */
+- (void)connectionDidBecomeIdle:(_SPLRemoteObjectHostConnection *)connection;
+
+/**
+ @abstract  Removes all connections. Idle connections are disconnected, connections with pending invocations are kept until they become idle so that their invocations still complete.
+ */
+- (void)drain;
+
+@end
+
+NS_ASSUME_NONNULL_END
@@ -0,0 +1,200 @@
+//
+//  _SPLRemoteObjectConnectionPool.m
+//  SPLRemoteObject
+//
+//  The MIT License (MIT)
+//  Copyright (c) 2013 Oliver Letterer, Sparrow-Labs
+//
+//  Permission is hereby granted, free of charge, to any person obtaining a copy
+//  of this software and associated documentation files (the "Software"), to deal
+//  in the Software without restriction, including without limitation the rights
+//  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+//  copies of the Software, and to permit persons to whom the Software is
+//  furnished to do so, subject to the following conditions:
+//
+//  The above copyright notice and this permission notice shall be included in
+//  all copies or substantial portions of the Software.
+//
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+//  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+//  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+//  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+//  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+//  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+//  THE SOFTWARE.
+//
+#import "_SPLRemoteObjectConnectionPool.h"
+
+
+
+@interface _SPLRemoteObjectConnectionPool () {
+    NSMutableArray *_connections;
+    NSMapTable *_idleSinceDates;
+    NSMutableSet *_retiredConnections; // left the pool while busy, nothing else retains them
+}
+
+@end
+
+
+
+@implementation _SPLRemoteObjectConnectionPool
+
+#pragma mark - setters and getters
+
+- (NSArray *)connections
+{
+    return [_connections copy];
+}
+
+- (void)setMaximumNumberOfConnections:(NSUInteger)maximumNumberOfConnections
+{
+    _maximumNumberOfConnections = maximumNumberOfConnections;
+
+    while (_connections.count > _maximumNumberOfConnections) {
+        [self _retireConnection:_connections.firstObject];
+    }
+}
+
+#pragma mark - Initialization
+
+- (instancetype)init
+{
+    if (self = [super init]) {
+        _maximumNumberOfConnections = 4;
+        _idleTimeoutInterval = 30.0;
+        _eventLoop = [_SPLRemoteObjectEventLoop mainEventLoop];
+
+        _connections = [NSMutableArray array];
+        _idleSinceDates = [NSMapTable strongToStrongObjectsMapTable];
+        _retiredConnections = [NSMutableSet set];
+    }
+    return self;
+}
+
+#pragma mark - Memory management
+
+- (void)dealloc
+{
+    for (_SPLRemoteObjectHostConnection *connection in [_connections arrayByAddingObjectsFromArray:_retiredConnections.allObjects]) {
+        [connection disconnect];
+    }
+}
+
+#pragma mark - Instance methods
+
+- (_SPLRemoteObjectHostConnection *)connectionToHost:(NSString *)host port:(NSInteger)port
+{
+    _SPLRemoteObjectHostConnection *leastBusyConnection = nil;
+
+    for (_SPLRemoteObjectHostConnection *connection in [_connections copy]) {
+        if (!connection.isConnected) {
+            [self removeConnection:connection];
+            continue;
+        }
+
+        if (connection.port != port || ![connection.host isEqual:host]) {
+            continue;
+        }
+
+        if (!leastBusyConnection || connection.pendingInvocations.count < leastBusyConnection.pendingInvocations.count) {
+            leastBusyConnection = connection;
+        }
+    }
+
+    if (leastBusyConnection.pendingInvocations.count > 0 && _connections.count < _maximumNumberOfConnections) {
+        return nil;
+    }
+
+    [_idleSinceDates removeObjectForKey:leastBusyConnection];
+    return leastBusyConnection;
+}
+
+- (BOOL)addConnection:(_SPLRemoteObjectHostConnection *)connection
+{
+    NSParameterAssert(connection);
+
+    if (_connections.count >= _maximumNumberOfConnections || _idleTimeoutInterval <= 0.0) {
+        return NO;
+    }
+
+    if (![_connections containsObject:connection]) {
+        [_connections addObject:connection];
+    }
+
+    return YES;
+}
+
+- (void)removeConnection:(_SPLRemoteObjectHostConnection *)connection
+{
+    if (!connection) {
+        return;
+    }
+
+    [_connections removeObject:connection];
+    [_idleSinceDates removeObjectForKey:connection];
+    [_retiredConnections removeObject:connection];
+}
+
+- (BOOL)containsConnection:(_SPLRemoteObjectHostConnection *)connection
+{
+    return [_connections containsObject:connection] || [_retiredConnections containsObject:connection];
+}
+
+- (void)connectionDidBecomeIdle:(_SPLRemoteObjectHostConnection *)connection
+{
+    NSParameterAssert(connection);
+
+    if ([_retiredConnections containsObject:connection]) {
+        [_retiredConnections removeObject:connection];
+        [connection disconnectAfterSendingQueuedDataWithCompletionHandler:nil];
+        return;
+    }
+
+    if (![_connections containsObject:connection]) {
+        return;
+    }
+
+    NSDate *idleSinceDate = [NSDate date];
+    [_idleSinceDates setObject:idleSinceDate forKey:connection];
+
+    __weak typeof(self) weakSelf = self;
+    __weak _SPLRemoteObjectHostConnection *weakConnection = connection;
+    [_eventLoop performBlock:^{
+        __strong typeof(weakSelf) strongSelf = weakSelf;
+        __strong _SPLRemoteObjectHostConnection *strongConnection = weakConnection;
+        [strongSelf _evictConnection:strongConnection ifIdleSinceDate:idleSinceDate];
+    } afterDelay:_idleTimeoutInterval];
+}
+
+- (void)drain
+{
+    for (_SPLRemoteObjectHostConnection *connection in [_connections copy]) {
+        [self _retireConnection:connection];
+    }
+}
+
+#pragma mark - Private category implementation ()
+
+- (void)_retireConnection:(_SPLRemoteObjectHostConnection *)connection
+{
+    [self removeConnection:connection];
+
+    // disconnecting silently would drop pending invocations without calling their completion handlers
+    if (connection.isConnected && connection.pendingInvocations.count > 0) {
+        [_retiredConnections addObject:connection];
+    } else {
+        [connection disconnect];
+    }
+}
+
+- (void)_evictConnection:(_SPLRemoteObjectHostConnection *)connection ifIdleSinceDate:(NSDate *)idleSinceDate
+{
+    if (!connection || [_idleSinceDates objectForKey:connection] != idleSinceDate || connection.pendingInvocations.count > 0) {
+        return;
+    }
+
+    [self removeConnection:connection];
+    [connection disconnect];
+}
+
+@end
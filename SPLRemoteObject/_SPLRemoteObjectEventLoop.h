@@ -0,0 +1,66 @@
+//
+//  _SPLRemoteObjectEventLoop.h
+//  SPLRemoteObject
+//
+//  The MIT License (MIT)
+//  Copyright (c) 2013 Oliver Letterer, Sparrow-Labs
+//
+//  Permission is hereby granted, free of charge, to any person obtaining a copy
+//  of this software and associated documentation files (the "Software"), to deal
+//  in the Software without restriction, including without limitation the rights
+//  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+//  copies of the Software, and to permit persons to whom the Software is
+//  furnished to do so, subject to the following conditions:
+//
+//  The above copyright notice and this permission notice shall be included in
+//  all copies or substantial portions of the Software.
+//
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+//  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+//  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+//  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+//  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+//  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+//  THE SOFTWARE.
+//
+
+#import <Foundation/Foundation.h>
+
+NS_ASSUME_NONNULL_BEGIN
+
+/**
+ @abstract  A run loop which owns sockets, streams and timers of connections. Either the main run loop or the run loop of a dedicated networking thread.
+ */
+@interface _SPLRemoteObjectEventLoop : NSObject
+
++ (instancetype)mainEventLoop;
+
+/**
+ @abstract  A single dedicated networking thread, used by remote objects and for accepting connections.
+ */
++ (instancetype)networkEventLoop;
+
+/**
+ @abstract  One networking thread per active processor, `networkEventLoop` is the first of them. Created on first use.
+ */
++ (NSArray<_SPLRemoteObjectEventLoop *> *)networkEventLoops;
+
+/**
+ @abstract  Distributes work round-robin across `networkEventLoops`.
+ */
++ (instancetype)nextNetworkEventLoop;
+
+@property (nonatomic, readonly) NSRunLoop *runLoop;
+@property (nonatomic, readonly) BOOL isCurrentEventLoop;
+
+- (instancetype)init UNAVAILABLE_ATTRIBUTE;
+
+/**
+ @abstract  Executes block asynchronously on this event loop.
+ */
+- (void)performBlock:(dispatch_block_t)block;
+- (void)performBlock:(dispatch_block_t)block afterDelay:(NSTimeInterval)delay;
+
+@end
+
+NS_ASSUME_NONNULL_END
@@ -0,0 +1,168 @@
+//
+//  _SPLRemoteObjectEventLoop.m
+//  SPLRemoteObject
+//
+//  The MIT License (MIT)
+//  Copyright (c) 2013 Oliver Letterer, Sparrow-Labs
+//
+//  Permission is hereby granted, free of charge, to any person obtaining a copy
+//  of this software and associated documentation files (the "Software"), to deal
+//  in the Software without restriction, including without limitation the rights
+//  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+//  copies of the Software, and to permit persons to whom the Software is
+//  furnished to do so, subject to the following conditions:
+//
+//  The above copyright notice and this permission notice shall be included in
+//  all copies or substantial portions of the Software.
+//
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+//  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+//  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+//  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+//  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+//  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+//  THE SOFTWARE.
+//
+
+#import "_SPLRemoteObjectEventLoop.h"
+#import <stdatomic.h>
+
+
+
+@interface _SPLRemoteObjectEventLoop ()
+
+@property (nonatomic, strong) NSRunLoop *runLoop;
+@property (nonatomic, strong) NSThread *thread;
+
+@end
+
+
+
+@implementation _SPLRemoteObjectEventLoop
+
++ (instancetype)mainEventLoop
+{
+    static _SPLRemoteObjectEventLoop *eventLoop = nil;
+    static dispatch_once_t onceToken;
+    dispatch_once(&onceToken, ^{
+        eventLoop = [[self alloc] _initWithThread:[NSThread mainThread] runLoop:[NSRunLoop mainRunLoop]];
+    });
+
+    return eventLoop;
+}
+
++ (instancetype)networkEventLoop
+{
+    static _SPLRemoteObjectEventLoop *eventLoop = nil;
+    static dispatch_once_t onceToken;
+    dispatch_once(&onceToken, ^{
+        eventLoop = [self _eventLoopWithDedicatedThreadNamed:@"de.sparrow-labs.SPLRemoteObject.network.0"];
+    });
+
+    return eventLoop;
+}
+
++ (NSArray<_SPLRemoteObjectEventLoop *> *)networkEventLoops
+{
+    static NSArray *eventLoops = nil;
+    static dispatch_once_t onceToken;
+    dispatch_once(&onceToken, ^{
+        // the remaining threads are only started once a proxy spreads its connections
+        NSUInteger numberOfEventLoops = MAX([NSProcessInfo processInfo].activeProcessorCount, 1);
+        NSMutableArray *mutableEventLoops = [NSMutableArray arrayWithObject:[self networkEventLoop]];
+
+        for (NSUInteger i = 1; i < numberOfEventLoops; i++) {
+            NSString *name = [NSString stringWithFormat:@"de.sparrow-labs.SPLRemoteObject.network.%lu", (unsigned long)i];
+            [mutableEventLoops addObject:[self _eventLoopWithDedicatedThreadNamed:name]];
+        }
+
+        eventLoops = [mutableEventLoops copy];
+    });
+
+    return eventLoops;
+}
+
++ (instancetype)nextNetworkEventLoop
+{
+    static atomic_uint counter = 0;
+
+    NSArray *eventLoops = [self networkEventLoops];
+    unsigned int index = atomic_fetch_add_explicit(&counter, 1, memory_order_relaxed);
+
+    return eventLoops[index % eventLoops.count];
+}
+
+#pragma mark - setters and getters
+
+- (BOOL)isCurrentEventLoop
+{
+    return [NSThread currentThread] == _thread;
+}
+
+#pragma mark - Instance methods
+
+- (void)performBlock:(dispatch_block_t)block
+{
+    NSParameterAssert(block);
+
+    CFRunLoopRef runLoop = _runLoop.getCFRunLoop;
+    CFRunLoopPerformBlock(runLoop, kCFRunLoopCommonModes, block);
+    CFRunLoopWakeUp(runLoop);
+}
+
+- (void)performBlock:(dispatch_block_t)block afterDelay:(NSTimeInterval)delay
+{
+    NSParameterAssert(block);
+
+    dispatch_time_t popTime = dispatch_time(DISPATCH_TIME_NOW, (int64_t)(delay * NSEC_PER_SEC));
+    dispatch_after(popTime, dispatch_get_global_queue(DISPATCH_QUEUE_PRIORITY_DEFAULT, 0), ^{
+        [self performBlock:block];
+    });
+}
+
+#pragma mark - Private category implementation ()
+
++ (instancetype)_eventLoopWithDedicatedThreadNamed:(NSString *)name
+{
+    dispatch_semaphore_t semaphore = dispatch_semaphore_create(0);
+    __block NSRunLoop *runLoop = nil;
+
+    NSThread *thread = [[NSThread alloc] initWithTarget:self selector:@selector(_runEventLoopWithStartBlock:) object:^(NSRunLoop *threadRunLoop) {
+        runLoop = threadRunLoop;
+        dispatch_semaphore_signal(semaphore);
+    }];
+    thread.name = name;
+    [thread start];
+
+    dispatch_semaphore_wait(semaphore, DISPATCH_TIME_FOREVER);
+
+    return [[self alloc] _initWithThread:thread runLoop:runLoop];
+}
+
++ (void)_runEventLoopWithStartBlock:(void(^)(NSRunLoop *runLoop))startBlock
+{
+    @autoreleasepool {
+        NSRunLoop *runLoop = [NSRunLoop currentRunLoop];
+
+        // keeps the run loop alive while no stream is scheduled
+        [runLoop addPort:[NSMachPort port] forMode:NSDefaultRunLoopMode];
+        startBlock(runLoop);
+    }
+
+    while (YES) {
+        @autoreleasepool {
+            [[NSRunLoop currentRunLoop] runMode:NSDefaultRunLoopMode beforeDate:[NSDate distantFuture]];
+        }
+    }
+}
+
+- (instancetype)_initWithThread:(NSThread *)thread runLoop:(NSRunLoop *)runLoop
+{
+    if (self = [super init]) {
+        _thread = thread;
+        _runLoop = runLoop;
+    }
+    return self;
+}
+
+@end
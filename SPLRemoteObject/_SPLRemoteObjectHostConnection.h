@@ -25,6 +25,7 @@
 //
 
 #import "_SPLRemoteObjectConnection.h"
+#import "_SPLRemoteObjectCompression.h"
 
 NS_ASSUME_NONNULL_BEGIN
 
@@ -35,7 +36,21 @@ NS_ASSUME_NONNULL_BEGIN
 
 @property (nonatomic, readonly) NSString *host;
 @property (nonatomic, readonly) NSInteger port;
-@property (nonatomic, nullable, copy) id completionBlock;
+
+/**
+ Invocations which have been sent over this connection and are still waiting for a response, keyed by their frame identifier.
+ */
+@property (nonatomic, readonly) NSMutableDictionary *pendingInvocations;
+
+/**
+ Method identifiers the remote host rejected during the handshake, nil until the handshake response arrived.
+ */
+@property (nonatomic, copy, nullable) NSIndexSet *incompatibleMethodIdentifiers;
+
+/**
+ Codec the remote host accepted during the handshake, none until the handshake response arrived.
+ */
+@property (atomic, assign) _SPLRemoteObjectCompressionCodec compressionCodec;
 
 - (instancetype)initWithHostAddress:(NSString *)host port:(NSInteger)port;
 
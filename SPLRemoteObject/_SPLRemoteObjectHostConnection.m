@@ -52,6 +52,7 @@
     if (self = [super init]) {
         _host = host;
         _port = port;
+        _pendingInvocations = [NSMutableDictionary dictionary];
     }
     return self;
 }
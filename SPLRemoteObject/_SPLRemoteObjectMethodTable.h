@@ -0,0 +1,134 @@
+//
+//  _SPLRemoteObjectMethodTable.h
+//  SPLRemoteObject
+//
+//  The MIT License (MIT)
+//  Copyright (c) 2013 Oliver Letterer, Sparrow-Labs
+//
+//  Permission is hereby granted, free of charge, to any person obtaining a copy
+//  of this software and associated documentation files (the "Software"), to deal
+//  in the Software without restriction, including without limitation the rights
+//  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+//  copies of the Software, and to permit persons to whom the Software is
+//  furnished to do so, subject to the following conditions:
+//
+//  The above copyright notice and this permission notice shall be included in
+//  all copies or substantial portions of the Software.
+//
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+//  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+//  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+//  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+//  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+//  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+//  THE SOFTWARE.
+//
+
+#import <Foundation/Foundation.h>
+#import "SPLRemoteObjectGeneratedCode.h"
+
+NS_ASSUME_NONNULL_BEGIN
+
+typedef NS_ENUM(NSInteger, _SPLRemoteObjectCompletionHandlerKind) {
+    _SPLRemoteObjectCompletionHandlerKindNone = 0,
+    _SPLRemoteObjectCompletionHandlerKindError, // (w|W)ithCompletionHandler:
+    _SPLRemoteObjectCompletionHandlerKindResults, // (w|W)ithResultsCompletionHandler:
+    _SPLRemoteObjectCompletionHandlerKindStreamingResults, // (w|W)ithStreamingResultsHandler:
+    _SPLRemoteObjectCompletionHandlerKindOneway, // - (oneway void), no completion handler and no response
+};
+
+/**
+ @abstract  Everything SPLRemoteObject and SPLRemoteObjectProxy need to know about one protocol method, computed once.
+ */
+@interface _SPLRemoteObjectMethod : NSObject
+
+@property (nonatomic, readonly) SEL selector;
+@property (nonatomic, readonly) NSString *selectorName;
+@property (nonatomic, readonly) NSMethodSignature *methodSignature;
+@property (nonatomic, readonly) const char *typeEncoding;
+
+/**
+ Index in `methods` of the method table. Requests carry this identifier instead of the selector once the handshake exchanged the method table.
+ */
+@property (nonatomic, readonly) uint32_t identifier;
+
+/**
+ MD5 hex digest of the selector name and the type encodings of the method, identical on both ends of a connection if the protocols match.
+ */
+@property (nonatomic, readonly) NSString *protocolHash;
+
+@property (nonatomic, readonly) _SPLRemoteObjectCompletionHandlerKind completionHandlerKind;
+
+/**
+ Number of arguments between `self, _cmd` and the completion handler, all arguments after `self, _cmd` for one-way methods.
+ */
+@property (nonatomic, readonly) NSUInteger numberOfObjectArguments;
+
+/**
+ NO if any of these arguments is a scalar or struct, which are sent as raw values and always go through NSInvocation.
+ */
+@property (nonatomic, readonly) BOOL hasOnlyObjectArguments;
+
+/**
+ NSSecureCoding classes named in the extended type encoding of this method, including its completion handler.
+ */
+@property (nonatomic, readonly) NSSet<Class> *allowedClasses;
+
+/**
+ Reason why this method can not be called remotely or nil.
+ */
+@property (nonatomic, readonly, nullable) NSString *unsupportedReason;
+
+/**
+ Typed client stub and server skeleton registered by generated code, nil otherwise.
+ */
+@property (atomic, copy, nullable) id stubImplementation;
+@property (atomic, copy, nullable) SPLRemoteObjectSkeleton skeleton;
+
+/**
+ @abstract  Validates `completionBlock` against this method. Results are cached per block signature, so repeated calls from the same call site cost a single lookup.
+ @param resultClass Class of the first argument of a results or streaming results handler, Nil for error completion handlers.
+ */
+- (BOOL)validateCompletionBlock:(id)completionBlock resultClass:(Class _Nullable * _Nullable)resultClass failureReason:(NSString * _Nullable * _Nullable)failureReason;
+
+@end
+
+
+
+/**
+ @abstract  Immutable table of all methods of a protocol, built on first use and shared by all remote objects and proxies of that protocol.
+ */
+@interface _SPLRemoteObjectMethodTable : NSObject
+
++ (instancetype)methodTableForProtocol:(Protocol *)protocol;
+
+@property (nonatomic, readonly) Protocol *protocol;
+
+/**
+ All methods sorted by selector name.
+ */
+@property (nonatomic, readonly) NSArray<_SPLRemoteObjectMethod *> *methods;
+
+/**
+ Union of `allowedClasses` of all methods, the only classes besides Foundation classes that keyed archives of this protocol may contain.
+ */
+@property (nonatomic, readonly) NSSet<Class> *allowedClasses;
+
+- (nullable _SPLRemoteObjectMethod *)methodForSelector:(SEL)selector;
+- (nullable _SPLRemoteObjectMethod *)methodForSelectorName:(NSString *)selectorName;
+
+/**
+ Selector names and protocol hashes of all methods, ordered by identifier. Sent to the remote host during the handshake.
+ */
+@property (nonatomic, readonly) NSArray *handshakeRepresentation;
+
+/**
+ @return Local methods indexed by the identifiers of the remote table. Methods which do not exist locally or whose protocol hash does not match are represented by NSNull.
+ */
+- (NSArray *)methodsMatchingHandshakeRepresentation:(NSArray *)handshakeRepresentation;
+
+- (instancetype)init UNAVAILABLE_ATTRIBUTE;
+
+@end
+
+NS_ASSUME_NONNULL_END
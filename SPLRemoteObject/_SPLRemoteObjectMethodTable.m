@@ -0,0 +1,437 @@
+//
+//  _SPLRemoteObjectMethodTable.m
+//  SPLRemoteObject
+//
+//  The MIT License (MIT)
+//  Copyright (c) 2013 Oliver Letterer, Sparrow-Labs
+//
+//  Permission is hereby granted, free of charge, to any person obtaining a copy
+//  of this software and associated documentation files (the "Software"), to deal
+//  in the Software without restriction, including without limitation the rights
+//  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+//  copies of the Software, and to permit persons to whom the Software is
+//  furnished to do so, subject to the following conditions:
+//
+//  The above copyright notice and this permission notice shall be included in
+//  all copies or substantial portions of the Software.
+//
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+//  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+//  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+//  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+//  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+//  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+//  THE SOFTWARE.
+//
+
+#import "_SPLRemoteObjectMethodTable.h"
+#import "SLBlockDescription.h"
+#import "_SPLRemoteObjectBinaryCodec.h"
+#import <objc/runtime.h>
+#import <pthread.h>
+#import <CommonCrypto/CommonDigest.h>
+
+// extended type encodings name the classes of object arguments, e.g. @"NSString" or @?<v@?@"NSArray"@"NSError">
+extern const char *_protocol_getMethodTypeEncoding(Protocol *protocol, SEL selector, BOOL isRequiredMethod, BOOL isInstanceMethod);
+
+static BOOL signatureMatches(const char *signature1, const char *signature2)
+{
+    return signature1[0] == signature2[0];
+}
+
+static const char *block_getSignature(id block)
+{
+    struct SLBlockLiteral *blockRef = (__bridge struct SLBlockLiteral *)block;
+
+    if (!(blockRef->flags & SLBlockDescriptionFlagsHasSignature)) {
+        return NULL;
+    }
+
+    void *signatureLocation = blockRef->descriptor;
+    signatureLocation += sizeof(unsigned long int);
+    signatureLocation += sizeof(unsigned long int);
+
+    if (blockRef->flags & SLBlockDescriptionFlagsHasCopyDispose) {
+        signatureLocation += sizeof(void(*)(void *dst, void *src));
+        signatureLocation += sizeof(void (*)(void *src));
+    }
+
+    return *(const char **)signatureLocation;
+}
+
+static NSString *methodSignature_getProtocolHash(SEL selector, NSMethodSignature *signature)
+{
+    NSMutableString *stringToHash = [NSMutableString stringWithString:NSStringFromSelector(selector)];
+    [stringToHash appendFormat:@"%c", signature.methodReturnType[0]];
+
+    for (NSInteger i = 0; i < signature.numberOfArguments; i++) {
+        const char *type = [signature getArgumentTypeAtIndex:i];
+
+        // struct arguments are sent field by field, both ends must agree on the layout
+        if (type[0] == '{') {
+            [stringToHash appendFormat:@"%s", type];
+        } else {
+            [stringToHash appendFormat:@"%c", type[0]];
+        }
+    }
+
+    const char *string = stringToHash.UTF8String;
+    unsigned char md5Buffer[CC_MD5_DIGEST_LENGTH];
+    CC_MD5(string, (CC_LONG)strlen(string), md5Buffer);
+
+    // Convert MD5 value in the buffer to NSString of hex values
+    NSMutableString *hash = [NSMutableString stringWithCapacity:CC_MD5_DIGEST_LENGTH * 2];
+    for(int i = 0; i < CC_MD5_DIGEST_LENGTH; i++) {
+        [hash appendFormat:@"%02x", md5Buffer[i]];
+    }
+
+    return hash;
+}
+
+static NSSet *typeEncoding_getSecureCodingClasses(const char *typeEncoding)
+{
+    NSMutableSet *classes = [NSMutableSet set];
+
+    for (const char *type = typeEncoding ? strstr(typeEncoding, "@\"") : NULL; type != NULL; type = strstr(type, "@\"")) {
+        type += 2;
+
+        // protocol qualified types like @"NSObject<NSSecureCoding>" name their class first
+        size_t length = strcspn(type, "\"<");
+        Class class = length > 0 ? NSClassFromString([[NSString alloc] initWithBytes:type length:length encoding:NSUTF8StringEncoding]) : Nil;
+
+        if ([class conformsToProtocol:@protocol(NSSecureCoding)]) {
+            [classes addObject:class];
+        }
+
+        type = strchr(type, '"');
+        if (!type) {
+            break;
+        }
+        type++;
+    }
+
+    return classes;
+}
+
+
+
+@interface _SPLRemoteObjectCompletionBlockValidation : NSObject
+
+@property (nonatomic, assign) Class resultClass;
+@property (nonatomic, copy) NSString *failureReason;
+
+@end
+
+@implementation _SPLRemoteObjectCompletionBlockValidation @end
+
+
+
+@interface _SPLRemoteObjectMethod () {
+    pthread_mutex_t _completionBlockValidationsLock;
+}
+
+@property (nonatomic, assign) uint32_t identifier;
+
+// keyed by the signature of the block, which is a constant of its call site
+@property (nonatomic, readonly) NSMapTable *completionBlockValidations;
+
+- (instancetype)initWithMethodDescription:(struct objc_method_description)methodDescription extendedTypeEncoding:(const char *)extendedTypeEncoding;
+
+@end
+
+@implementation _SPLRemoteObjectMethod
+
+- (instancetype)initWithMethodDescription:(struct objc_method_description)methodDescription extendedTypeEncoding:(const char *)extendedTypeEncoding
+{
+    if (self = [super init]) {
+        _selector = methodDescription.name;
+        _selectorName = NSStringFromSelector(methodDescription.name);
+        _methodSignature = [NSMethodSignature signatureWithObjCTypes:methodDescription.types];
+        _typeEncoding = methodDescription.types;
+        _protocolHash = methodSignature_getProtocolHash(_selector, _methodSignature);
+        _allowedClasses = [typeEncoding_getSecureCodingClasses(extendedTypeEncoding) copy];
+
+        // protocol type encodings keep the oneway qualifier of the return type
+        BOOL isOneway = _typeEncoding[0] == 'V';
+
+        if (isOneway) {
+            _completionHandlerKind = _SPLRemoteObjectCompletionHandlerKindOneway;
+        } else if ([_selectorName hasSuffix:@"WithStreamingResultsHandler:"] || [_selectorName hasSuffix:@"withStreamingResultsHandler:"]) {
+            _completionHandlerKind = _SPLRemoteObjectCompletionHandlerKindStreamingResults;
+        } else if ([_selectorName hasSuffix:@"WithResultsCompletionHandler:"] || [_selectorName hasSuffix:@"withResultsCompletionHandler:"]) {
+            _completionHandlerKind = _SPLRemoteObjectCompletionHandlerKindResults;
+        } else if ([_selectorName hasSuffix:@"WithCompletionHandler:"] || [_selectorName hasSuffix:@"withCompletionHandler:"]) {
+            _completionHandlerKind = _SPLRemoteObjectCompletionHandlerKindError;
+        }
+
+        pthread_mutex_init(&_completionBlockValidationsLock, NULL);
+        _completionBlockValidations = [NSMapTable mapTableWithKeyOptions:NSPointerFunctionsOpaqueMemory | NSPointerFunctionsOpaquePersonality valueOptions:NSPointerFunctionsStrongMemory];
+
+        NSUInteger numberOfArguments = _methodSignature.numberOfArguments;
+        NSUInteger endOfArguments = isOneway ? numberOfArguments : numberOfArguments - 1;
+        _numberOfObjectArguments = endOfArguments >= 2 ? endOfArguments - 2 : 0;
+        _hasOnlyObjectArguments = YES;
+
+        if (!isOneway && !signatureMatches(_methodSignature.methodReturnType, @encode(void))) {
+            _unsupportedReason = @"can only call methods with a void return type";
+        } else if (!isOneway && (numberOfArguments < 3 || !signatureMatches([_methodSignature getArgumentTypeAtIndex:numberOfArguments - 1], @encode(dispatch_block_t)))) {
+            _unsupportedReason = @"the last argument must a completion block";
+        } else {
+            for (NSUInteger i = 2; i < endOfArguments; i++) {
+                const char *type = [_methodSignature getArgumentTypeAtIndex:i];
+                if (signatureMatches(type, @encode(id))) {
+                    continue;
+                }
+
+                _hasOnlyObjectArguments = NO;
+
+                if (![_SPLRemoteObjectBinaryCodec supportsValueOfType:type]) {
+                    _unsupportedReason = @"all arguments must be an id typed subclass, a scalar or a struct of scalars";
+                    break;
+                }
+            }
+        }
+    }
+    return self;
+}
+
+- (void)dealloc
+{
+    pthread_mutex_destroy(&_completionBlockValidationsLock);
+}
+
+- (BOOL)validateCompletionBlock:(id)completionBlock resultClass:(Class *)resultClass failureReason:(NSString **)failureReason
+{
+    NSParameterAssert(completionBlock);
+
+    const char *signature = block_getSignature(completionBlock);
+
+    pthread_mutex_lock(&_completionBlockValidationsLock);
+    _SPLRemoteObjectCompletionBlockValidation *validation = signature ? [_completionBlockValidations objectForKey:(__bridge id)(void *)signature] : nil;
+    pthread_mutex_unlock(&_completionBlockValidationsLock);
+
+    if (!validation) {
+        validation = [self _validateCompletionBlockSignature:signature];
+
+        if (signature) {
+            pthread_mutex_lock(&_completionBlockValidationsLock);
+            [_completionBlockValidations setObject:validation forKey:(__bridge id)(void *)signature];
+            pthread_mutex_unlock(&_completionBlockValidationsLock);
+        }
+    }
+
+    if (resultClass) {
+        *resultClass = validation.resultClass;
+    }
+
+    if (failureReason) {
+        *failureReason = validation.failureReason;
+    }
+
+    return validation.failureReason == nil;
+}
+
+- (NSString *)description
+{
+    return [NSString stringWithFormat:@"%@: %@", [super description], _selectorName];
+}
+
+#pragma mark - Private category implementation ()
+
+- (_SPLRemoteObjectCompletionBlockValidation *)_validateCompletionBlockSignature:(const char *)signature
+{
+    _SPLRemoteObjectCompletionBlockValidation *validation = [[_SPLRemoteObjectCompletionBlockValidation alloc] init];
+    NSMethodSignature *blockSignature = signature ? [NSMethodSignature signatureWithObjCTypes:signature] : nil;
+
+    // block return type must be void
+    if (blockSignature && !signatureMatches(blockSignature.methodReturnType, @encode(void))) {
+        validation.failureReason = @"completion handler can only have void return type";
+    } else if (blockSignature.numberOfArguments == 4) {
+        // void(^)(id item, BOOL finished, NSError *error)
+        NSString *resultType = [NSString stringWithFormat:@"%s", [blockSignature getArgumentTypeAtIndex:1]];
+        const char *finishedType = [blockSignature getArgumentTypeAtIndex:2];
+        NSString *errorType = [NSString stringWithFormat:@"%s", [blockSignature getArgumentTypeAtIndex:3]];
+        Class resultClass = resultType.length > 3 ? NSClassFromString([resultType substringWithRange:NSMakeRange(2, resultType.length - 3)]) : Nil;
+
+        if (_completionHandlerKind != _SPLRemoteObjectCompletionHandlerKindStreamingResults) {
+            validation.failureReason = @"method must end in (w|W)ithStreamingResultsHandler:";
+        } else if (!signatureMatches(resultType.UTF8String, @encode(id))) {
+            validation.failureReason = @"first streaming results handler argument must be id typed";
+        } else if (![resultClass conformsToProtocol:@protocol(NSSecureCoding)]) {
+            validation.failureReason = @"first streaming results handler argument must conform to NSSecureCoding";
+        } else if (!signatureMatches(finishedType, @encode(BOOL))) {
+            validation.failureReason = @"second streaming results handler argument must be a BOOL";
+        } else if (![errorType isEqual:@"@\"NSError\""]) {
+            validation.failureReason = @"third streaming results handler argument must be an NSError";
+        }
+
+        validation.resultClass = resultClass;
+    } else if (blockSignature.numberOfArguments == 3) {
+        NSString *resultType = [NSString stringWithFormat:@"%s", [blockSignature getArgumentTypeAtIndex:1]];
+        NSString *errorType = [NSString stringWithFormat:@"%s", [blockSignature getArgumentTypeAtIndex:2]];
+        Class resultClass = resultType.length > 3 ? NSClassFromString([resultType substringWithRange:NSMakeRange(2, resultType.length - 3)]) : Nil;
+
+        if (_completionHandlerKind != _SPLRemoteObjectCompletionHandlerKindResults) {
+            validation.failureReason = @"method must end in (w|W)ithResultsCompletionHandler:";
+        } else if (!signatureMatches(resultType.UTF8String, @encode(id))) {
+            validation.failureReason = @"first completion handler argument must be id typed";
+        } else if (![resultClass conformsToProtocol:@protocol(NSSecureCoding)]) {
+            validation.failureReason = @"first completion handler argument must conform to NSSecureCoding";
+        } else if (![errorType isEqual:@"@\"NSError\""]) {
+            validation.failureReason = @"second completion handler argument must be an NSError";
+        }
+
+        validation.resultClass = resultClass;
+    } else if (blockSignature.numberOfArguments == 2) {
+        NSString *errorType = [NSString stringWithFormat:@"%s", [blockSignature getArgumentTypeAtIndex:1]];
+
+        if (_completionHandlerKind != _SPLRemoteObjectCompletionHandlerKindError) {
+            validation.failureReason = @"method must end in (w|W)ithCompletionHandler:";
+        } else if (![errorType isEqual:@"@\"NSError\""]) {
+            validation.failureReason = @"completion handler argument must be an NSError";
+        }
+    } else {
+        validation.failureReason = @"completion handler not supported";
+    }
+
+    return validation;
+}
+
+@end
+
+
+
+@interface _SPLRemoteObjectMethodTable ()
+
+@property (nonatomic, readonly) NSMapTable *methodsBySelector;
+@property (nonatomic, readonly) NSDictionary *methodsBySelectorName;
+
+@end
+
+
+
+@implementation _SPLRemoteObjectMethodTable
+
++ (instancetype)methodTableForProtocol:(Protocol *)protocol
+{
+    NSParameterAssert(protocol);
+
+    static NSMapTable *methodTables = nil;
+    static dispatch_once_t onceToken;
+    dispatch_once(&onceToken, ^{
+        methodTables = [NSMapTable mapTableWithKeyOptions:NSPointerFunctionsOpaqueMemory | NSPointerFunctionsOpaquePersonality valueOptions:NSPointerFunctionsStrongMemory];
+    });
+
+    @synchronized(methodTables) {
+        _SPLRemoteObjectMethodTable *methodTable = [methodTables objectForKey:(__bridge id)(__bridge void *)protocol];
+
+        if (!methodTable) {
+            methodTable = [[self alloc] _initWithProtocol:protocol];
+            [methodTables setObject:methodTable forKey:(__bridge id)(__bridge void *)protocol];
+        }
+
+        return methodTable;
+    }
+}
+
+- (_SPLRemoteObjectMethod *)methodForSelector:(SEL)selector
+{
+    return [_methodsBySelector objectForKey:(__bridge id)(void *)selector];
+}
+
+- (_SPLRemoteObjectMethod *)methodForSelectorName:(NSString *)selectorName
+{
+    return _methodsBySelectorName[selectorName];
+}
+
+- (NSArray *)methodsMatchingHandshakeRepresentation:(NSArray *)handshakeRepresentation
+{
+    NSMutableArray *methods = [NSMutableArray arrayWithCapacity:handshakeRepresentation.count];
+
+    for (id entry in handshakeRepresentation) {
+        _SPLRemoteObjectMethod *method = nil;
+
+        if ([entry isKindOfClass:[NSArray class]] && [entry count] == 2) {
+            method = [self methodForSelectorName:entry[0]];
+
+            if (![method.protocolHash isEqual:entry[1]]) {
+                method = nil;
+            }
+        }
+
+        [methods addObject:method ?: [NSNull null]];
+    }
+
+    return methods;
+}
+
+#pragma mark - Private category implementation ()
+
+- (instancetype)_initWithProtocol:(Protocol *)protocol
+{
+    if (self = [super init]) {
+        _protocol = protocol;
+
+        NSMutableDictionary *methodsBySelectorName = [NSMutableDictionary dictionary];
+        [self _collectMethodsOfProtocol:protocol intoDictionary:methodsBySelectorName];
+
+        _methods = [methodsBySelectorName.allValues sortedArrayUsingComparator:^NSComparisonResult(_SPLRemoteObjectMethod *method1, _SPLRemoteObjectMethod *method2) {
+            return [method1.selectorName compare:method2.selectorName];
+        }];
+
+        _methodsBySelectorName = [methodsBySelectorName copy];
+        _methodsBySelector = [NSMapTable mapTableWithKeyOptions:NSPointerFunctionsOpaqueMemory | NSPointerFunctionsOpaquePersonality valueOptions:NSPointerFunctionsStrongMemory];
+
+        NSMutableSet *allowedClasses = [NSMutableSet set];
+
+        [_methods enumerateObjectsUsingBlock:^(_SPLRemoteObjectMethod *method, NSUInteger index, BOOL *stop) {
+            method.identifier = (uint32_t)index;
+            [_methodsBySelector setObject:method forKey:(__bridge id)(void *)method.selector];
+            [allowedClasses unionSet:method.allowedClasses];
+        }];
+
+        _allowedClasses = [allowedClasses copy];
+
+        NSMutableArray *handshakeRepresentation = [NSMutableArray arrayWithCapacity:_methods.count];
+        for (_SPLRemoteObjectMethod *method in _methods) {
+            [handshakeRepresentation addObject:@[ method.selectorName, method.protocolHash ]];
+        }
+        _handshakeRepresentation = [handshakeRepresentation copy];
+    }
+    return self;
+}
+
+- (void)_collectMethodsOfProtocol:(Protocol *)protocol intoDictionary:(NSMutableDictionary *)methodsBySelectorName
+{
+    // NSObject methods are never forwarded
+    if (protocol_isEqual(protocol, @protocol(NSObject))) {
+        return;
+    }
+
+    for (NSInteger isRequiredMethod = 1; isRequiredMethod >= 0; isRequiredMethod--) {
+        unsigned int count = 0;
+        struct objc_method_description *methodDescriptions = protocol_copyMethodDescriptionList(protocol, (BOOL)isRequiredMethod, YES, &count);
+
+        for (unsigned int i = 0; i < count; i++) {
+            NSString *selectorName = NSStringFromSelector(methodDescriptions[i].name);
+
+            if (!methodsBySelectorName[selectorName]) {
+                const char *extendedTypeEncoding = _protocol_getMethodTypeEncoding(protocol, methodDescriptions[i].name, (BOOL)isRequiredMethod, YES);
+                methodsBySelectorName[selectorName] = [[_SPLRemoteObjectMethod alloc] initWithMethodDescription:methodDescriptions[i] extendedTypeEncoding:extendedTypeEncoding];
+            }
+        }
+
+        free(methodDescriptions);
+    }
+
+    unsigned int count = 0;
+    Protocol * __unsafe_unretained *protocols = protocol_copyProtocolList(protocol, &count);
+
+    for (unsigned int i = 0; i < count; i++) {
+        [self _collectMethodsOfProtocol:protocols[i] intoDictionary:methodsBySelectorName];
+    }
+
+    free(protocols);
+}
+
+@end
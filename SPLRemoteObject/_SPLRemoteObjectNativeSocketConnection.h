@@ -25,6 +25,8 @@
 //
 
 #import "_SPLRemoteObjectConnection.h"
+#import "_SPLRemoteObjectCompression.h"
+#import "SPLRemoteObjectCancellationToken.h"
 
 NS_ASSUME_NONNULL_BEGIN
 
@@ -35,6 +37,33 @@ NS_ASSUME_NONNULL_BEGIN
 
 @property (nonatomic, readonly) CFSocketNativeHandle nativeSocketHandle;
 
+/**
+ Local methods indexed by the method identifiers of the client, nil until the client sent its handshake.
+ */
+@property (nonatomic, copy, nullable) NSArray *methods;
+
+/**
+ Codec chosen from the codecs the client offered in its handshake, used to compress responses.
+ */
+@property (nonatomic, assign) _SPLRemoteObjectCompressionCodec compressionCodec;
+
+/**
+ Event names the client subscribed to, events are pushed to this connection until it disconnects.
+ */
+@property (atomic, copy) NSSet<NSString *> *subscribedEventNames;
+
+/**
+ @abstract  Tracks the cancellation token of every request which is being served, keyed by frame identifier. Can be called from any thread.
+ */
+- (SPLRemoteObjectCancellationToken *)beginRequestWithIdentifier:(uint32_t)identifier;
+- (void)endRequestWithIdentifier:(uint32_t)identifier;
+- (void)cancelRequestWithIdentifier:(uint32_t)identifier;
+
+/**
+ @abstract  Cancels all requests, nobody is waiting for their responses once the client disconnected.
+ */
+- (void)cancelAllRequests;
+
 - (instancetype)initWithNativeSocketHandle:(CFSocketNativeHandle)nativeSocketHandle;
 
 @end
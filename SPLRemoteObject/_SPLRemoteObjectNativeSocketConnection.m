@@ -29,7 +29,7 @@
 
 
 @interface _SPLRemoteObjectNativeSocketConnection () {
-    
+    NSMutableDictionary *_cancellationTokens;
 }
 
 @end
@@ -51,6 +51,8 @@
 {
     if (self = [super init]) {
         _nativeSocketHandle = nativeSocketHandle;
+        _subscribedEventNames = [NSSet set];
+        _cancellationTokens = [NSMutableDictionary dictionary];
     }
     return self;
 }
@@ -78,6 +80,50 @@
     _nativeSocketHandle = -1;
 }
 
+#pragma mark - Instance methods
+
+- (SPLRemoteObjectCancellationToken *)beginRequestWithIdentifier:(uint32_t)identifier
+{
+    SPLRemoteObjectCancellationToken *cancellationToken = [[SPLRemoteObjectCancellationToken alloc] init];
+
+    @synchronized(_cancellationTokens) {
+        _cancellationTokens[@(identifier)] = cancellationToken;
+    }
+
+    return cancellationToken;
+}
+
+- (void)endRequestWithIdentifier:(uint32_t)identifier
+{
+    @synchronized(_cancellationTokens) {
+        [_cancellationTokens removeObjectForKey:@(identifier)];
+    }
+}
+
+- (void)cancelRequestWithIdentifier:(uint32_t)identifier
+{
+    SPLRemoteObjectCancellationToken *cancellationToken = nil;
+
+    @synchronized(_cancellationTokens) {
+        cancellationToken = _cancellationTokens[@(identifier)];
+        [_cancellationTokens removeObjectForKey:@(identifier)];
+    }
+
+    [cancellationToken cancel];
+}
+
+- (void)cancelAllRequests
+{
+    NSArray *cancellationTokens = nil;
+
+    @synchronized(_cancellationTokens) {
+        cancellationTokens = _cancellationTokens.allValues;
+        [_cancellationTokens removeAllObjects];
+    }
+
+    [cancellationTokens makeObjectsPerformSelector:@selector(cancel)];
+}
+
 #pragma mark - Memory management
 
 - (void)dealloc
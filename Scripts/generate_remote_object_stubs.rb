@@ -0,0 +1,178 @@
+#!/usr/bin/env ruby
+#
+#  generate_remote_object_stubs.rb
+#  SPLRemoteObject
+#
+#  The MIT License (MIT)
+#  Copyright (c) 2013 Oliver Letterer, Sparrow-Labs
+#
+#  Permission is hereby granted, free of charge, to any person obtaining a copy
+#  of this software and associated documentation files (the "Software"), to deal
+#  in the Software without restriction, including without limitation the rights
+#  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+#  copies of the Software, and to permit persons to whom the Software is
+#  furnished to do so, subject to the following conditions:
+#
+#  The above copyright notice and this permission notice shall be included in
+#  all copies or substantial portions of the Software.
+#
+#  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+#  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+#  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+#  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+#  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+#  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+#  THE SOFTWARE.
+#
+#  Reads the @protocol declarations of an Objective-C header and writes typed client stubs and
+#  server skeletons for them. Add the generated file to the targets of both SPLRemoteObject and
+#  SPLRemoteObjectProxy, it registers itself when the binary is loaded.
+#
+#  usage: generate_remote_object_stubs.rb Header.h [Output.m]
+#
+
+Argument = Struct.new(:type, :name)
+RemoteMethod = Struct.new(:selector, :arguments, :oneway)
+
+def strip_comments(source)
+  source.gsub(%r{/\*.*?\*/}m, '').gsub(%r{//[^\n]*}, '')
+end
+
+def parse_argument_type(type)
+  # removing nullability leaves whitespace behind, block types are normalised to `(^)` so that block_parameter can name them
+  type = type.gsub(/\b(nullable|nonnull|_Nullable|_Nonnull|__nullable|__nonnull|null_unspecified)\b/, '')
+  type.gsub(/\s+/, ' ').gsub(/\(\s*\^\s*\)/, '(^)').gsub(/\s+([,)])/, '\\1').gsub(/\(\s+/, '(').strip
+end
+
+def parse_method(declaration)
+  declaration = declaration.gsub(/\s+/, ' ').strip
+  return nil unless declaration =~ /\A-\s*\(\s*(oneway\s+)?void\s*\)\s*(.*)\z/
+  oneway = !$1.nil?
+  remainder = $2
+
+  selector = ''
+  arguments = []
+
+  # one-way methods without arguments have a plain selector
+  return RemoteMethod.new(remainder, [], true) if oneway && remainder =~ /\A\w+\z/
+
+  until remainder.empty?
+    return nil unless remainder =~ /\A(\w+)\s*:\s*\(/
+    selector << $1 << ':'
+    remainder = $'
+
+    depth = 1
+    index = 0
+    while depth > 0
+      return nil if index >= remainder.length
+      depth += 1 if remainder[index] == '('
+      depth -= 1 if remainder[index] == ')'
+      index += 1
+    end
+
+    type = parse_argument_type(remainder[0...(index - 1)])
+    remainder = remainder[index..-1]
+
+    return nil unless remainder =~ /\A\s*(\w+)\s*/
+    arguments << Argument.new(type, $1)
+    remainder = $'
+  end
+
+  # one-way methods have no completion handler, all of their arguments are objects
+  objects = oneway ? arguments : arguments[0...-1]
+  return nil if !oneway && (arguments.empty? || !arguments.last.type.include?('^'))
+  return nil unless objects.all? { |argument| argument.type.include?('*') || argument.type =~ /\Aid\b/ }
+
+  RemoteMethod.new(selector, arguments, oneway)
+end
+
+def parse_protocols(source)
+  protocols = {}
+
+  strip_comments(source).scan(/@protocol\s+(\w+)[^;]*?\n(.*?)@end/m) do |name, body|
+    methods = body.split(';').map { |declaration| declaration.gsub(/@(required|optional)/, '') }.select { |declaration| declaration.strip.start_with?('-') }
+    protocols[name] = methods.map do |declaration|
+      method = parse_method(declaration)
+      $stderr.puts "warning: skipping #{name} #{declaration.strip}, only one-way methods and methods with object arguments and a trailing completion handler are supported" unless method
+      method
+    end.compact
+  end
+
+  protocols
+end
+
+def parameter(argument)
+  argument.type.end_with?('*') ? "#{argument.type}#{argument.name}" : "#{argument.type} #{argument.name}"
+end
+
+def block_parameter(argument)
+  argument.type.sub('(^)', "(^#{argument.name})")
+end
+
+def generate_registration(protocol, methods)
+  lines = []
+  lines << "__attribute__((constructor)) static void SPLRemoteObjectRegister#{protocol}(void)"
+  lines << '{'
+  lines << '    @autoreleasepool {'
+
+  methods.each_with_index do |method, method_index|
+    objects = method.oneway ? method.arguments : method.arguments[0...-1]
+    completion_handler = method.oneway ? nil : method.arguments.last
+    parameters = ['SPLRemoteObject *remoteObject'] + objects.map { |argument| parameter(argument) }
+    parameters << block_parameter(completion_handler) if completion_handler
+    encoded_arguments = objects.empty? ? '@[]' : "@[ #{objects.map { |argument| "SPLRemoteObjectArgument(#{argument.name})" }.join(', ')} ]"
+
+    keywords = method.selector.split(':')
+    call = keywords.each_with_index.map do |keyword, index|
+      value = completion_handler && index == keywords.length - 1 ? 'completionHandler' : "SPLRemoteObjectArgumentAtIndex(arguments, #{index})"
+      "#{keyword}:#{value}"
+    end.join(' ')
+    call = method.selector if method.arguments.empty?
+
+    lines << '' if method_index > 0
+    lines << "        SPLRemoteObjectRegisterStub(@protocol(#{protocol}), @selector(#{method.selector}), ^(#{parameters.join(', ')}) {"
+    lines << "            SPLRemoteObjectInvokeRemoteMethod(remoteObject, @selector(#{method.selector}), #{encoded_arguments}, #{completion_handler ? completion_handler.name : 'nil'});"
+    lines << '        });'
+    lines << "        SPLRemoteObjectRegisterSkeleton(@protocol(#{protocol}), @selector(#{method.selector}), ^(id target, NSArray *arguments, id completionHandler) {"
+    lines << "            [(id<#{protocol}>)target #{call}];"
+    lines << '        });'
+  end
+
+  lines << '    }'
+  lines << '}'
+  lines.join("\n")
+end
+
+def generate(header_path, protocols)
+  output = []
+  output << "// Generated by generate_remote_object_stubs.rb from #{File.basename(header_path)}, do not edit."
+  output << ''
+  output << "#import \"#{File.basename(header_path)}\""
+  output << '#import "SPLRemoteObjectGeneratedCode.h"'
+
+  protocols.each do |protocol, methods|
+    next if methods.empty?
+    output << ''
+    output << ''
+    output << ''
+    output << generate_registration(protocol, methods)
+  end
+
+  output.join("\n") + "\n"
+end
+
+if ARGV.empty? || ARGV.length > 2
+  $stderr.puts "usage: #{File.basename($0)} Header.h [Output.m]"
+  exit 1
+end
+
+header_path = ARGV[0]
+output_path = ARGV[1] || header_path.sub(/\.h\z/, '') + 'RemoteObjectStubs.m'
+
+protocols = parse_protocols(File.read(header_path))
+if protocols.empty?
+  $stderr.puts "error: #{header_path} does not declare any protocol"
+  exit 1
+end
+
+File.open(output_path, 'w') { |file| file.write(generate(header_path, protocols)) }
@@ -0,0 +1,42 @@
+//
+//  GeneratedSampleProtocol.h
+//  SPLRemoteObject
+//
+//  The MIT License (MIT)
+//  Copyright (c) 2013 Oliver Letterer, Sparrow-Labs
+//
+//  Permission is hereby granted, free of charge, to any person obtaining a copy
+//  of this software and associated documentation files (the "Software"), to deal
+//  in the Software without restriction, including without limitation the rights
+//  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+//  copies of the Software, and to permit persons to whom the Software is
+//  furnished to do so, subject to the following conditions:
+//
+//  The above copyright notice and this permission notice shall be included in
+//  all copies or substantial portions of the Software.
+//
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+//  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+//  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+//  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+//  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+//  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+//  THE SOFTWARE.
+//
+
+#import <Foundation/Foundation.h>
+
+NS_ASSUME_NONNULL_BEGIN
+
+/**
+ Typed stubs and skeletons for this protocol are generated into GeneratedSampleProtocolRemoteObjectStubs.m, regenerate them with `rake generate HEADER=Tests/SLRemoteObjectTests/GeneratedSampleProtocol.h`.
+ */
+@protocol GeneratedSampleProtocol <NSObject>
+
+- (void)add:(NSNumber *)a to:(NSNumber *)b completionHandler:(void (^ _Nullable)(NSNumber * _Nullable sum, NSError * _Nullable error))completionHandler;
+- (void)greet:(nullable NSString *)name withCompletionHandler:(void(^)(NSError * _Nullable error))completionHandler;
+- (oneway void)reset;
+
+@end
+
+NS_ASSUME_NONNULL_END
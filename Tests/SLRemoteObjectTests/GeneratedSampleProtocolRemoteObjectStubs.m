@@ -0,0 +1,32 @@
+// Generated by generate_remote_object_stubs.rb from GeneratedSampleProtocol.h, do not edit.
+
+#import "GeneratedSampleProtocol.h"
+#import "SPLRemoteObjectGeneratedCode.h"
+
+
+
+__attribute__((constructor)) static void SPLRemoteObjectRegisterGeneratedSampleProtocol(void)
+{
+    @autoreleasepool {
+        SPLRemoteObjectRegisterStub(@protocol(GeneratedSampleProtocol), @selector(add:to:completionHandler:), ^(SPLRemoteObject *remoteObject, NSNumber *a, NSNumber *b, void (^completionHandler)(NSNumber * sum, NSError * error)) {
+            SPLRemoteObjectInvokeRemoteMethod(remoteObject, @selector(add:to:completionHandler:), @[ SPLRemoteObjectArgument(a), SPLRemoteObjectArgument(b) ], completionHandler);
+        });
+        SPLRemoteObjectRegisterSkeleton(@protocol(GeneratedSampleProtocol), @selector(add:to:completionHandler:), ^(id target, NSArray *arguments, id completionHandler) {
+            [(id<GeneratedSampleProtocol>)target add:SPLRemoteObjectArgumentAtIndex(arguments, 0) to:SPLRemoteObjectArgumentAtIndex(arguments, 1) completionHandler:completionHandler];
+        });
+
+        SPLRemoteObjectRegisterStub(@protocol(GeneratedSampleProtocol), @selector(greet:withCompletionHandler:), ^(SPLRemoteObject *remoteObject, NSString *name, void(^completionHandler)(NSError * error)) {
+            SPLRemoteObjectInvokeRemoteMethod(remoteObject, @selector(greet:withCompletionHandler:), @[ SPLRemoteObjectArgument(name) ], completionHandler);
+        });
+        SPLRemoteObjectRegisterSkeleton(@protocol(GeneratedSampleProtocol), @selector(greet:withCompletionHandler:), ^(id target, NSArray *arguments, id completionHandler) {
+            [(id<GeneratedSampleProtocol>)target greet:SPLRemoteObjectArgumentAtIndex(arguments, 0) withCompletionHandler:completionHandler];
+        });
+
+        SPLRemoteObjectRegisterStub(@protocol(GeneratedSampleProtocol), @selector(reset), ^(SPLRemoteObject *remoteObject) {
+            SPLRemoteObjectInvokeRemoteMethod(remoteObject, @selector(reset), @[], nil);
+        });
+        SPLRemoteObjectRegisterSkeleton(@protocol(GeneratedSampleProtocol), @selector(reset), ^(id target, NSArray *arguments, id completionHandler) {
+            [(id<GeneratedSampleProtocol>)target reset];
+        });
+    }
+}
@@ -26,10 +26,21 @@
 
 #import <XCTest/XCTest.h>
 #import <Foundation/Foundation.h>
+#import <CoreGraphics/CoreGraphics.h>
 #import <CTOpenSSLWrapper.h>
 #import <SPLRemoteObjectBrowser.h>
 #import "SPLRemoteObjectProxy.h"
 #import "SPLRemoteObject.h"
+#import "_SPLRemoteObjectNativeSocketConnection.h"
+#import "_SPLRemoteObjectBinaryCodec.h"
+#import "_SPLRemoteObjectCompression.h"
+#import "_SPLNil.h"
+#import "_SPLRemoteObjectMethodTable.h"
+#import "GeneratedSampleProtocol.h"
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include <arpa/inet.h>
+#include <unistd.h>
 #define EXP_SHORTHAND YES
 #import "Expecta.h"
 #import "OCMock.h"
@@ -42,12 +53,30 @@
 - (void)sayHelloWithResultsCompletionHandler:(void(^)(NSString *response, NSError *error))completionHandler;
 - (void)sayHelloForAction:(NSString *)action withResultsCompletionHandler:(void(^)(NSString *response, NSError *error))completionHandler;
 
+- (void)sumOfValue:(NSInteger)value point:(CGPoint)point flag:(BOOL)flag withResultsCompletionHandler:(void(^)(NSNumber *sum, NSError *error))completionHandler;
+- (void)echoData:(NSData *)data withResultsCompletionHandler:(void(^)(NSData *data, NSError *error))completionHandler;
+- (void)countToNumber:(NSNumber *)number withStreamingResultsHandler:(void(^)(NSNumber *item, BOOL finished, NSError *error))streamingResultsHandler;
+
+- (oneway void)logEvent:(NSString *)event;
+
+- (void)waitForCancellationWithCompletionHandler:(void(^)(NSError *error))completionHandler;
+- (void)waitForInterval:(NSNumber *)interval withCompletionHandler:(void(^)(NSError *error))completionHandler;
+
 @end
 
 
 
 @interface SPLRemoteObjectProxyTestTarget : NSObject<SampleProtocol>
 @property (nonatomic, copy) NSString *action;
+@property (atomic, copy) NSString *loggedEvent;
+@property (atomic, strong) SPLRemoteObjectCancellationToken *cancellationToken;
+@property (atomic, assign) NSUInteger numberOfGreetings;
+@property (atomic, assign) BOOL holdsGreetings;
+@property (nonatomic, strong) NSMutableArray *heldGreetingCompletionHandlers;
+@property (atomic, assign) NSUInteger numberOfRunningWaits;
+@property (atomic, assign) NSUInteger maximumNumberOfRunningWaits;
+
+- (void)releaseHeldGreetings;
 @end
 
 @implementation SPLRemoteObjectProxyTestTarget
@@ -60,9 +89,79 @@
 - (void)sayHelloForAction:(NSString *)action withResultsCompletionHandler:(void(^)(NSString *response, NSError *error))completionHandler
 {
     self.action = action;
+    self.numberOfGreetings++;
+
+    if (self.holdsGreetings) {
+        if (!self.heldGreetingCompletionHandlers) {
+            self.heldGreetingCompletionHandlers = [NSMutableArray array];
+        }
+        [self.heldGreetingCompletionHandlers addObject:[completionHandler copy]];
+        return;
+    }
+
     completionHandler(@"hey there sexy.", nil);
 }
 
+- (void)releaseHeldGreetings
+{
+    self.holdsGreetings = NO;
+
+    NSArray *completionHandlers = self.heldGreetingCompletionHandlers;
+    self.heldGreetingCompletionHandlers = nil;
+
+    for (void(^completionHandler)(NSString *response, NSError *error) in completionHandlers) {
+        completionHandler(@"hey there sexy.", nil);
+    }
+}
+
+- (void)sumOfValue:(NSInteger)value point:(CGPoint)point flag:(BOOL)flag withResultsCompletionHandler:(void(^)(NSNumber *sum, NSError *error))completionHandler
+{
+    completionHandler(@(value + point.x + point.y + (flag ? 1 : 0)), nil);
+}
+
+- (void)echoData:(NSData *)data withResultsCompletionHandler:(void(^)(NSData *data, NSError *error))completionHandler
+{
+    completionHandler(data, nil);
+}
+
+- (void)countToNumber:(NSNumber *)number withStreamingResultsHandler:(void(^)(NSNumber *item, BOOL finished, NSError *error))streamingResultsHandler
+{
+    for (NSInteger i = 1; i <= number.integerValue; i++) {
+        streamingResultsHandler(@(i), NO, nil);
+    }
+
+    streamingResultsHandler(nil, YES, nil);
+}
+
+- (oneway void)logEvent:(NSString *)event
+{
+    self.loggedEvent = event;
+}
+
+- (void)waitForCancellationWithCompletionHandler:(void(^)(NSError *error))completionHandler
+{
+    self.cancellationToken = [SPLRemoteObjectCancellationToken currentToken];
+    [self.cancellationToken addCancellationHandler:^{
+        completionHandler(nil);
+    }];
+}
+
+- (void)waitForInterval:(NSNumber *)interval withCompletionHandler:(void(^)(NSError *error))completionHandler
+{
+    @synchronized(self) {
+        self.numberOfRunningWaits++;
+        self.maximumNumberOfRunningWaits = MAX(self.maximumNumberOfRunningWaits, self.numberOfRunningWaits);
+    }
+
+    [NSThread sleepForTimeInterval:interval.doubleValue];
+
+    @synchronized(self) {
+        self.numberOfRunningWaits--;
+    }
+
+    completionHandler(nil);
+}
+
 - (void)performActionWithCompletionHandler:(void(^)(NSError *error))completionHandler
 {
     completionHandler(nil);
@@ -76,6 +175,43 @@
 
 @end
 
+@interface SPLRemoteObjectGeneratedTestTarget : NSObject<GeneratedSampleProtocol>
+@property (atomic, copy) NSString *greetedName;
+@property (atomic, assign) BOOL didReset;
+@end
+
+@implementation SPLRemoteObjectGeneratedTestTarget
+
+- (void)add:(NSNumber *)a to:(NSNumber *)b completionHandler:(void (^)(NSNumber *, NSError *))completionHandler
+{
+    completionHandler(@(a.integerValue + b.integerValue), nil);
+}
+
+- (void)greet:(NSString *)name withCompletionHandler:(void (^)(NSError *))completionHandler
+{
+    self.greetedName = name ?: @"nobody";
+    completionHandler(nil);
+}
+
+- (oneway void)reset
+{
+    self.didReset = YES;
+}
+
+@end
+
+@interface SPLRemoteObjectProxyOtherTestTarget : SPLRemoteObjectProxyTestTarget
+@end
+
+@implementation SPLRemoteObjectProxyOtherTestTarget
+
+- (void)sayHelloWithResultsCompletionHandler:(void (^)(NSString *, NSError *))completionHandler
+{
+    completionHandler(@"hey there other.", nil);
+}
+
+@end
+
 @interface SPLRemoteObjectTestEncryptionPolicy : NSObject<SPLRemoteObjectEncryptionPolicy>
 
 @property (nonatomic, strong) NSString *key;
@@ -267,4 +403,624 @@
     expect(self.target.action).to.equal(@"action");
 }
 
+- (void)testInvocationWithScalarAndStructArguments
+{
+    __block NSNumber *sum = nil;
+
+    [_remoteObject sumOfValue:-3 point:CGPointMake(1.5, 2.0) flag:YES withResultsCompletionHandler:^(NSNumber *result, NSError *error) {
+        sum = result;
+    }];
+
+    expect(sum).will.equal(@1.5);
+}
+
+- (void)testInvocationWithLargeDataAttachments
+{
+    NSMutableData *data = [NSMutableData dataWithLength:4 * 1024 * 1024];
+    arc4random_buf(data.mutableBytes, data.length);
+
+    __block NSData *echoedData = nil;
+    [_remoteObject echoData:data withResultsCompletionHandler:^(NSData *result, NSError *error) {
+        echoedData = result;
+    }];
+
+    expect(echoedData).will.equal(data);
+}
+
+- (void)testInvocationWithStreamingResults
+{
+    NSMutableArray *items = [NSMutableArray array];
+    __block BOOL finished = NO;
+
+    [_remoteObject countToNumber:@100 withStreamingResultsHandler:^(NSNumber *item, BOOL isFinished, NSError *error) {
+        if (isFinished) {
+            finished = error == nil;
+        } else {
+            [items addObject:item];
+        }
+    }];
+
+    expect(finished).will.beTruthy();
+    expect(items.count).to.equal(100);
+    expect(items.firstObject).to.equal(@1);
+    expect(items.lastObject).to.equal(@100);
+}
+
+- (void)testThatRemoteObjectImplementsProtocolMethodsWithoutForwarding
+{
+    expect([self.remoteObject respondsToSelector:@selector(sayHelloWithResultsCompletionHandler:)]).to.beTruthy();
+    expect([self.remoteObject respondsToSelector:@selector(performAction:withCompletionHandler:)]).to.beTruthy();
+    expect([self.remoteObject class]).to.equal([SPLRemoteObject class]);
+}
+
+- (void)testThatStubImplementationsRejectArgumentsWithoutSecureCoding
+{
+    expect(^{
+        [self.remoteObject sayHelloForAction:(NSString *)[[NSObject alloc] init] withResultsCompletionHandler:^(NSString *response, NSError *error) {}];
+    }).to.raise(NSInvalidArgumentException);
+}
+
+- (void)testThatGeneratedStubsAndSkeletonsInvokeTheTarget
+{
+    _SPLRemoteObjectMethodTable *methodTable = [_SPLRemoteObjectMethodTable methodTableForProtocol:@protocol(GeneratedSampleProtocol)];
+    for (_SPLRemoteObjectMethod *method in methodTable.methods) {
+        expect(method.stubImplementation).toNot.beNil();
+        expect(method.skeleton).toNot.beNil();
+    }
+
+    SPLRemoteObjectGeneratedTestTarget *target = [[SPLRemoteObjectGeneratedTestTarget alloc] init];
+    SPLRemoteObjectProxy *proxy __attribute__((objc_precise_lifetime)) = [[SPLRemoteObjectProxy alloc] initWithName:@"generated" type:self.proxy.type protocol:@protocol(GeneratedSampleProtocol) target:target completionHandler:^(NSError *error) {
+
+    }];
+    SPLRemoteObject<GeneratedSampleProtocol> *remoteObject = (id)[[SPLRemoteObject alloc] initWithName:@"generated" type:self.proxy.type protocol:@protocol(GeneratedSampleProtocol)];
+
+    __block NSNumber *sum = nil;
+    [remoteObject add:@2 to:@3 completionHandler:^(NSNumber *result, NSError *error) {
+        sum = result;
+    }];
+    expect(sum).will.equal(@5);
+
+    __block BOOL greeted = NO;
+    [remoteObject greet:nil withCompletionHandler:^(NSError *error) {
+        greeted = error == nil;
+    }];
+    expect(greeted).will.beTruthy();
+    expect(target.greetedName).to.equal(@"nobody");
+
+    [remoteObject reset];
+    expect(target.didReset).will.beTruthy();
+}
+
+- (void)testThatCompletionHandlersAreCalledOnCompletionQueue
+{
+    dispatch_queue_t completionQueue = dispatch_queue_create("de.sparrow-labs.SPLRemoteObjectTests.completion", DISPATCH_QUEUE_SERIAL);
+    static void *completionQueueKey = &completionQueueKey;
+    dispatch_queue_set_specific(completionQueue, completionQueueKey, completionQueueKey, NULL);
+
+    __block BOOL calledOnCompletionQueue = NO;
+    __block BOOL calledOnScopedQueue = NO;
+
+    self.remoteObject.completionQueue = completionQueue;
+    [_remoteObject sayHelloWithResultsCompletionHandler:^(NSString *responseeeee, NSError *error) {
+        calledOnCompletionQueue = dispatch_get_specific(completionQueueKey) == completionQueueKey;
+    }];
+
+    [self.remoteObject performWithCompletionQueue:dispatch_get_main_queue() block:^{
+        [_remoteObject performActionWithCompletionHandler:^(NSError *error) {
+            calledOnScopedQueue = [NSThread currentThread].isMainThread;
+        }];
+    }];
+
+    expect(calledOnCompletionQueue).will.beTruthy();
+    expect(calledOnScopedQueue).will.beTruthy();
+}
+
+- (void)testThatProxyInvokesNewTargetAfterTargetChanges
+{
+    __block NSString *response = nil;
+
+    [_remoteObject sayHelloWithResultsCompletionHandler:^(NSString *responseeeee, NSError *error) {
+        response = responseeeee;
+    }];
+    expect(response).will.equal(@"hey there sexy.");
+
+    self.target = [[SPLRemoteObjectProxyOtherTestTarget alloc] init];
+    self.proxy.target = self.target;
+
+    [_remoteObject sayHelloWithResultsCompletionHandler:^(NSString *responseeeee, NSError *error) {
+        response = responseeeee;
+    }];
+    expect(response).will.equal(@"hey there other.");
+}
+
+- (void)testThatOnewayMethodsAreDeliveredWithoutResponse
+{
+    self.remoteObject.maximumConnectionPoolSize = 0;
+    [self.remoteObject logEvent:@"unpooled"];
+    expect(self.target.loggedEvent).will.equal(@"unpooled");
+
+    self.remoteObject.maximumConnectionPoolSize = 1;
+    [self.remoteObject logEvent:@"pooled"];
+    expect(self.target.loggedEvent).will.equal(@"pooled");
+}
+
+- (void)testThatSubscribersReceivePushedEvents
+{
+    __block NSString *receivedEvent = nil;
+    id subscription = [self.remoteObject subscribeToEventNamed:@"status" handler:^(NSString *event) {
+        receivedEvent = event;
+    }];
+
+    // subscribing is asynchronous, keep pushing until the subscription reached the proxy
+    SPLRemoteObjectProxy *proxy = self.proxy;
+    dispatch_source_t timer = dispatch_source_create(DISPATCH_SOURCE_TYPE_TIMER, 0, 0, dispatch_get_main_queue());
+    dispatch_source_set_timer(timer, DISPATCH_TIME_NOW, 0.1 * NSEC_PER_SEC, 0.01 * NSEC_PER_SEC);
+    dispatch_source_set_event_handler(timer, ^{
+        [proxy pushEvent:@"online" named:@"status"];
+        [proxy pushEvent:@"ignored" named:@"other"];
+    });
+    dispatch_resume(timer);
+
+    expect(receivedEvent).will.equal(@"online");
+
+    dispatch_source_cancel(timer);
+    [self.remoteObject unsubscribe:subscription];
+}
+
+- (void)testThatCancelledInvocationsFailAndCancelTheTargetToken
+{
+    __block NSError *receivedError = nil;
+    SPLRemoteObjectCancellationToken *cancellationToken = [self.remoteObject performCancellable:^{
+        [_remoteObject waitForCancellationWithCompletionHandler:^(NSError *error) {
+            receivedError = error;
+        }];
+    }];
+
+    expect(self.target.cancellationToken).willNot.beNil();
+    expect(self.target.cancellationToken.isCancelled).to.beFalsy();
+
+    [cancellationToken cancel];
+    expect(receivedError.code).will.equal(SPLRemoteObjectConnectionCancelled);
+    expect(self.target.cancellationToken.isCancelled).will.beTruthy();
+}
+
+- (void)testThatInvocationsFailOnceTheirDeadlinePassed
+{
+    // resolve the remote host first, the deadline only has to cover the invocation itself
+    __block NSString *response = nil;
+    [self.remoteObject sayHelloWithResultsCompletionHandler:^(NSString *result, NSError *error) {
+        response = result;
+    }];
+    expect(response).willNot.beNil();
+
+    __block NSError *receivedError = nil;
+    [self.remoteObject performWithDeadline:[NSDate dateWithTimeIntervalSinceNow:1.0] block:^{
+        [_remoteObject waitForCancellationWithCompletionHandler:^(NSError *error) {
+            receivedError = error;
+        }];
+    }];
+
+    expect(receivedError.code).will.equal(SPLRemoteObjectConnectionTimedOut);
+    expect(self.target.cancellationToken.isCancelled).will.beTruthy();
+}
+
+- (void)testThatIdenticalInvocationsShareOneRequest
+{
+    static NSUInteger const numberOfInvocations = 10;
+    self.remoteObject.coalescesIdenticalInvocations = YES;
+
+    // the first request is answered only after every invocation was issued, so all of them find it in flight
+    self.target.holdsGreetings = YES;
+
+    __block NSUInteger numberOfResponses = 0;
+    for (NSUInteger i = 0; i < numberOfInvocations; i++) {
+        [self.remoteObject sayHelloForAction:@"coalesced" withResultsCompletionHandler:^(NSString *response, NSError *error) {
+            if ([response isEqualToString:@"hey there sexy."]) {
+                numberOfResponses++;
+            }
+        }];
+    }
+
+    expect(self.target.numberOfGreetings).will.equal(1);
+    [self.target releaseHeldGreetings];
+
+    expect(numberOfResponses).will.equal(numberOfInvocations);
+    expect(self.target.numberOfGreetings).to.equal(1);
+}
+
+- (void)testThatShrinkingTheConnectionPoolCompletesInFlightInvocations
+{
+    self.proxy.targetQueue = dispatch_get_global_queue(DISPATCH_QUEUE_PRIORITY_DEFAULT, 0);
+
+    __block BOOL completed = NO;
+    __block NSError *receivedError = nil;
+    [self.remoteObject waitForInterval:@1.0 withCompletionHandler:^(NSError *error) {
+        receivedError = error;
+        completed = YES;
+    }];
+
+    expect(self.target.numberOfRunningWaits).will.equal(1);
+    self.remoteObject.maximumConnectionPoolSize = 0;
+
+    expect(completed).will.beTruthy();
+    expect(receivedError).to.beNil();
+}
+
+- (void)testThatConcurrentTargetQueuesRunSlowMethodsInParallel
+{
+    self.proxy.targetQueue = dispatch_get_global_queue(DISPATCH_QUEUE_PRIORITY_DEFAULT, 0);
+
+    __block NSUInteger numberOfResponses = 0;
+    for (NSUInteger i = 0; i < 2; i++) {
+        [self.remoteObject waitForInterval:@1.0 withCompletionHandler:^(NSError *error) {
+            if (!error) {
+                numberOfResponses++;
+            }
+        }];
+    }
+
+    expect(numberOfResponses).will.equal(2);
+    expect(self.target.maximumNumberOfRunningWaits).to.equal(2);
+}
+
+- (void)testThatBatchedInvocationsCallEveryCompletionHandler
+{
+    static NSUInteger const numberOfInvocations = 50;
+
+    __block NSUInteger numberOfResponses = 0;
+    __block BOOL calledWithoutResult = NO;
+
+    [self.remoteObject performBatch:^{
+        for (NSUInteger i = 0; i < numberOfInvocations; i++) {
+            [_remoteObject sayHelloForAction:@"batch" withResultsCompletionHandler:^(NSString *response, NSError *error) {
+                if ([response isEqualToString:@"hey there sexy."]) {
+                    numberOfResponses++;
+                }
+            }];
+        }
+
+        [_remoteObject performActionWithCompletionHandler:^(NSError *error) {
+            calledWithoutResult = error == nil;
+        }];
+    }];
+
+    expect(numberOfResponses).will.equal(numberOfInvocations);
+    expect(calledWithoutResult).will.beTruthy();
+    expect(self.target.action).to.equal(@"batch");
+}
+
+- (void)testThatDedicatedNetworkThreadsCompleteInvocationsOfManyClients
+{
+    static NSUInteger const numberOfClients = 8;
+    static NSUInteger const numberOfInvocations = 20;
+
+    self.proxy.usesDedicatedNetworkThread = YES;
+    self.proxy.targetQueue = dispatch_get_global_queue(DISPATCH_QUEUE_PRIORITY_DEFAULT, 0);
+
+    NSMutableArray *remoteObjects = [NSMutableArray arrayWithObject:self.remoteObject];
+    for (NSUInteger i = 1; i < numberOfClients; i++) {
+        [remoteObjects addObject:[[SPLRemoteObject alloc] initWithName:self.remoteObject.name type:self.remoteObject.type protocol:@protocol(SampleProtocol)]];
+    }
+
+    __block NSUInteger numberOfResponses = 0;
+    for (SPLRemoteObject<SampleProtocol> *remoteObject in remoteObjects) {
+        for (NSUInteger i = 0; i < numberOfInvocations; i++) {
+            [remoteObject sayHelloForAction:@"dedicated" withResultsCompletionHandler:^(NSString *response, NSError *error) {
+                if ([response isEqualToString:@"hey there sexy."]) {
+                    numberOfResponses++;
+                }
+            }];
+        }
+    }
+
+    expect(numberOfResponses).will.equal(numberOfClients * numberOfInvocations);
+}
+
+- (void)testThatPooledConnectionsReduceInvocationLatency
+{
+    static NSUInteger const numberOfInvocations = 50;
+    expect(self.remoteObject.reachabilityStatus).will.equal(SPLRemoteObjectReachabilityStatusAvailable);
+
+    __block NSDate *startDate = nil;
+    __block NSTimeInterval duration = 0.0;
+    __block NSUInteger remainingInvocations = 0;
+    __block void (^invokeNext)(void) = nil;
+
+    invokeNext = ^{
+        [self.remoteObject sayHelloWithResultsCompletionHandler:^(NSString *response, NSError *error) {
+            remainingInvocations--;
+
+            if (remainingInvocations == 0) {
+                duration = [[NSDate date] timeIntervalSinceDate:startDate];
+            } else {
+                invokeNext();
+            }
+        }];
+    };
+
+    self.remoteObject.maximumConnectionPoolSize = 0;
+    remainingInvocations = numberOfInvocations;
+    startDate = [NSDate date];
+    invokeNext();
+
+    expect(duration).will.beGreaterThan(0.0);
+    NSTimeInterval unpooledDuration = duration;
+
+    self.remoteObject.maximumConnectionPoolSize = 1;
+    duration = 0.0;
+    remainingInvocations = numberOfInvocations;
+    startDate = [NSDate date];
+    invokeNext();
+
+    expect(duration).will.beGreaterThan(0.0);
+    NSTimeInterval pooledDuration = duration;
+
+    invokeNext = nil;
+
+    // without a pool every invocation pays for its own connect and handshake
+    expect(pooledDuration).to.beLessThan(unpooledDuration);
+}
+
+@end
+
+
+
+static BOOL createLoopbackSocketPair(int sockets[2])
+{
+    int listeningSocket = socket(AF_INET, SOCK_STREAM, IPPROTO_TCP);
+
+    struct sockaddr_in socketAddress;
+    memset(&socketAddress, 0, sizeof(socketAddress));
+    socketAddress.sin_len = sizeof(socketAddress);
+    socketAddress.sin_family = AF_INET;
+    socketAddress.sin_port = 0;
+    socketAddress.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+
+    socklen_t socketAddressLength = sizeof(socketAddress);
+    if (bind(listeningSocket, (struct sockaddr *)&socketAddress, socketAddressLength) != 0 || listen(listeningSocket, 1) != 0 || getsockname(listeningSocket, (struct sockaddr *)&socketAddress, &socketAddressLength) != 0) {
+        close(listeningSocket);
+        return NO;
+    }
+
+    sockets[0] = socket(AF_INET, SOCK_STREAM, IPPROTO_TCP);
+    if (connect(sockets[0], (struct sockaddr *)&socketAddress, socketAddressLength) != 0) {
+        close(sockets[0]);
+        close(listeningSocket);
+        return NO;
+    }
+
+    sockets[1] = accept(listeningSocket, NULL, NULL);
+    close(listeningSocket);
+
+    return sockets[1] >= 0;
+}
+
+
+
+@interface SPLRemoteObjectConnectionBenchmark : XCTestCase <_SPLRemoteObjectConnectionDelegate>
+
+@property (nonatomic, strong) _SPLRemoteObjectNativeSocketConnection *sendingConnection;
+@property (nonatomic, strong) _SPLRemoteObjectNativeSocketConnection *receivingConnection;
+
+@property (nonatomic, assign) NSUInteger numberOfReceivedBytes;
+@property (nonatomic, assign) NSUInteger numberOfReceivedFrames;
+
+@end
+
+
+
+@implementation SPLRemoteObjectConnectionBenchmark
+
+- (void)setUp
+{
+    [super setUp];
+
+    [Expecta setAsynchronousTestTimeout:60.0];
+
+    int sockets[2];
+    XCTAssertTrue(createLoopbackSocketPair(sockets));
+
+    self.sendingConnection = [[_SPLRemoteObjectNativeSocketConnection alloc] initWithNativeSocketHandle:sockets[0]];
+    self.sendingConnection.delegate = self;
+    [self.sendingConnection connect];
+
+    self.receivingConnection = [[_SPLRemoteObjectNativeSocketConnection alloc] initWithNativeSocketHandle:sockets[1]];
+    self.receivingConnection.delegate = self;
+    [self.receivingConnection connect];
+}
+
+- (void)tearDown
+{
+    [self.sendingConnection disconnect];
+    [self.receivingConnection disconnect];
+
+    self.sendingConnection = nil;
+    self.receivingConnection = nil;
+
+    [super tearDown];
+}
+
+- (void)testReceiveThroughputFor1KBFrames
+{
+    [self _measureReceiveThroughputForFrameLength:1024];
+}
+
+- (void)testReceiveThroughputFor16KBFrames
+{
+    [self _measureReceiveThroughputForFrameLength:16 * 1024];
+}
+
+- (void)testReceiveThroughputFor256KBFrames
+{
+    [self _measureReceiveThroughputForFrameLength:256 * 1024];
+}
+
+- (void)testReceiveThroughputFor4MBFrames
+{
+    [self _measureReceiveThroughputForFrameLength:4 * 1024 * 1024];
+}
+
+- (void)testReceiveThroughputFor64MBFrames
+{
+    [self _measureReceiveThroughputForFrameLength:64 * 1024 * 1024];
+}
+
+- (void)_measureReceiveThroughputForFrameLength:(NSUInteger)frameLength
+{
+    static NSUInteger const numberOfBytesPerMeasurement = 64 * 1024 * 1024;
+    static NSTimeInterval const receiveTimeoutInterval = 60.0;
+
+    NSData *frame = [NSMutableData dataWithLength:frameLength];
+    NSUInteger numberOfFrames = numberOfBytesPerMeasurement / frameLength;
+
+    [self measureBlock:^{
+        self.numberOfReceivedBytes = 0;
+        self.numberOfReceivedFrames = 0;
+
+        for (NSUInteger i = 0; i < numberOfFrames; i++) {
+            [self.sendingConnection sendDataPackage:frame identifier:(uint32_t)i];
+        }
+
+        expect(self.numberOfReceivedFrames).after(receiveTimeoutInterval).to.equal(numberOfFrames);
+        expect(self.numberOfReceivedBytes).to.equal(numberOfFrames * frameLength);
+    }];
+}
+
+#pragma mark - _SPLRemoteObjectConnectionDelegate
+
+- (void)remoteObjectConnectionConnectionAttemptFailed:(_SPLRemoteObjectConnection *)connection
+{
+    XCTFail(@"connection attempt failed");
+}
+
+- (void)remoteObjectConnectionConnectionEnded:(_SPLRemoteObjectConnection *)connection
+{
+    XCTFail(@"connection ended");
+}
+
+- (void)remoteObjectConnection:(_SPLRemoteObjectConnection *)connection didReceiveDataPackage:(NSData *)dataPackage attachments:(NSArray *)attachments header:(_SPLRemoteObjectFrameHeader)header
+{
+    self.numberOfReceivedBytes += dataPackage.length;
+    self.numberOfReceivedFrames++;
+}
+
+@end
+
+
+
+@interface SPLRemoteObjectBinaryCodecBenchmark : XCTestCase
+
+@end
+
+
+
+@implementation SPLRemoteObjectBinaryCodecBenchmark
+
+- (void)testThatBinaryCodecRoundTripsFoundationObjects
+{
+    NSDictionary *object = @{
+                             @"string": @"hey there sexy.",
+                             @"integer": @-42,
+                             @"double": @3.5,
+                             @"bool": @YES,
+                             @"data": [@"data" dataUsingEncoding:NSUTF8StringEncoding],
+                             @"date": [NSDate dateWithTimeIntervalSinceReferenceDate:1000.0],
+                             @"array": @[ @1, @"2", [[_SPLNil alloc] init] ],
+                             @"archived": [NSURL URLWithString:@"http://sparrow-labs.de"],
+                             @"decimal": [NSDecimalNumber decimalNumberWithString:@"12345678901234567890.0123456789"],
+                             };
+
+    NSData *data = [_SPLRemoteObjectBinaryCodec dataWithRootObject:object];
+    NSDictionary *decodedObject = [_SPLRemoteObjectBinaryCodec rootObjectWithData:data];
+
+    expect(decodedObject[@"string"]).to.equal(object[@"string"]);
+    expect(decodedObject[@"integer"]).to.equal(object[@"integer"]);
+    expect(decodedObject[@"double"]).to.equal(object[@"double"]);
+    expect(decodedObject[@"bool"]).to.equal(@YES);
+    expect(decodedObject[@"data"]).to.equal(object[@"data"]);
+    expect(decodedObject[@"date"]).to.equal(object[@"date"]);
+    expect([decodedObject[@"array"] lastObject]).to.beKindOf([_SPLNil class]);
+    expect(decodedObject[@"archived"]).to.equal(object[@"archived"]);
+    expect(decodedObject[@"decimal"]).to.beKindOf([NSDecimalNumber class]);
+    expect(decodedObject[@"decimal"]).to.equal(object[@"decimal"]);
+
+    NSData *keyedArchive = [NSKeyedArchiver archivedDataWithRootObject:@[ @"fallback" ]];
+    expect([_SPLRemoteObjectBinaryCodec rootObjectWithData:keyedArchive]).to.equal(@[ @"fallback" ]);
+
+    NSIndexSet *indexSet = [NSIndexSet indexSetWithIndex:42];
+    NSData *unexpectedClassData = [_SPLRemoteObjectBinaryCodec dataWithRootObject:@[ indexSet ]];
+    expect(^{
+        [_SPLRemoteObjectBinaryCodec rootObjectWithData:unexpectedClassData];
+    }).to.raise(NSInvalidUnarchiveOperationException);
+    expect([_SPLRemoteObjectBinaryCodec rootObjectWithData:unexpectedClassData attachments:nil allowedClasses:[NSSet setWithObject:[NSIndexSet class]]]).to.equal(@[ indexSet ]);
+}
+
+- (void)testThatCompressionRoundTripsRedundantPayloads
+{
+    NSMutableArray *payload = [NSMutableArray array];
+    for (NSInteger i = 0; i < 1000; i++) {
+        [payload addObject:@{ @"identifier": @(i), @"name": @"hey there sexy." }];
+    }
+
+    NSData *data = [_SPLRemoteObjectBinaryCodec dataWithRootObject:payload];
+    uint8_t flags = 0;
+    NSData *compressedData = [_SPLRemoteObjectCompression dataByCompressingData:data codec:_SPLRemoteObjectCompressionCodecZlib flags:&flags];
+
+    expect(compressedData.length).to.beLessThan(data.length / 4);
+    expect(flags & _SPLRemoteObjectFrameFlagsCompressionCodecMask).to.equal(_SPLRemoteObjectCompressionCodecZlib);
+    expect([_SPLRemoteObjectCompression dataByDecompressingData:compressedData flags:flags]).to.equal(data);
+
+    NSData *smallData = [@"small" dataUsingEncoding:NSUTF8StringEncoding];
+    uint8_t smallFlags = 0;
+    expect([_SPLRemoteObjectCompression dataByCompressingData:smallData codec:_SPLRemoteObjectCompressionCodecZlib flags:&smallFlags]).to.equal(smallData);
+    expect(smallFlags).to.equal(0);
+}
+
+- (NSDictionary *)_benchmarkInvocation
+{
+    return @{
+             @"selector": @"sayHelloForAction:withResultsCompletionHandler:",
+             @"protocol_hash": @"0123456789abcdef0123456789abcdef",
+             @"objects": @[ @"action", @42, [[_SPLNil alloc] init] ],
+             };
+}
+
+- (void)testThatBinaryCodecIsSmallerThanKeyedArchiver
+{
+    NSDictionary *invocation = [self _benchmarkInvocation];
+
+    NSData *keyedArchive = [NSKeyedArchiver archivedDataWithRootObject:invocation];
+    NSData *binaryData = [_SPLRemoteObjectBinaryCodec dataWithRootObject:invocation];
+
+    expect(binaryData.length).to.beLessThan(keyedArchive.length);
+}
+
+- (void)testKeyedArchiverRoundTripPerformance
+{
+    static NSUInteger const numberOfIterations = 10000;
+    NSDictionary *invocation = [self _benchmarkInvocation];
+
+    [self measureBlock:^{
+        for (NSUInteger i = 0; i < numberOfIterations; i++) {
+            @autoreleasepool {
+                [NSKeyedUnarchiver unarchiveObjectWithData:[NSKeyedArchiver archivedDataWithRootObject:invocation]];
+            }
+        }
+    }];
+}
+
+- (void)testBinaryCodecRoundTripPerformance
+{
+    static NSUInteger const numberOfIterations = 10000;
+    NSDictionary *invocation = [self _benchmarkInvocation];
+
+    [self measureBlock:^{
+        for (NSUInteger i = 0; i < numberOfIterations; i++) {
+            @autoreleasepool {
+                [_SPLRemoteObjectBinaryCodec rootObjectWithData:[_SPLRemoteObjectBinaryCodec dataWithRootObject:invocation]];
+            }
+        }
+    }];
+}
+
 @end